@@ -0,0 +1,67 @@
+#ifndef BENCH_COMMON_H
+# define BENCH_COMMON_H
+
+# include "../include/cub3d.h"
+
+// --- Shared Benchmark Setup ---
+//
+// A headless world: a square map with a pillar every 4 cells, a lamp sprite
+// every 6 and a malloc'd framebuffer, so the render passes can run without
+// an X connection.
+
+# define BENCH_MAP 48
+
+static inline void bench_setup(t_params *params) {
+  int x, y;
+
+  ft_memset(params, 0, sizeof(*params));
+  params->map.rows = BENCH_MAP;
+  params->map.cols = BENCH_MAP;
+  params->map.map_data = malloc(BENCH_MAP * sizeof(char *));
+  for (y = 0; y < BENCH_MAP; y++) {
+    params->map.map_data[y] = malloc(BENCH_MAP + 1);
+    for (x = 0; x < BENCH_MAP; x++) {
+      bool border = x == 0 || y == 0 || x == BENCH_MAP - 1 || y == BENCH_MAP - 1;
+      params->map.map_data[y][x] =
+          (border || (x % 4 == 0 && y % 4 == 0)) ? WALL : EMPTY;
+      if (x % 6 == 3 && y % 6 == 3)
+        sprite_add(params, (x + 0.5) * TILE_SIZE, (y + 0.5) * TILE_SIZE,
+                   (x + y) / 6);
+    }
+    params->map.map_data[y][BENCH_MAP] = '\0';
+  }
+  params->player.x = (BENCH_MAP / 2 - 1.5) * TILE_SIZE;
+  params->player.y = (BENCH_MAP / 2 - 1.5) * TILE_SIZE;
+  params->dist_proj_plane = (WINDOW_WIDTH / 2.0) / tan(PLAYER_FOV / 2.0);
+  params->window_img.width = WINDOW_WIDTH;
+  params->window_img.height = WINDOW_HEIGHT;
+  params->window_img.bpp = 4;
+  params->window_img.bits_per_pixel = 32;
+  params->window_img.line_length = WINDOW_WIDTH * 4;
+  params->window_img.addr = malloc((size_t)WINDOW_WIDTH * WINDOW_HEIGHT * 4);
+}
+
+// Everything but the lightmap, which not every benchmark bakes.
+static inline int bench_init(t_params *params) {
+  bench_setup(params);
+  if (!params->window_img.addr || cells_init(params) ||
+      sprites_init(params) || render_init(params))
+    return -1;
+  return 0;
+}
+
+static inline void bench_free(t_params *params) {
+  int y;
+
+  interlace_free(params);
+  render_free(params);
+  lighting_free(params);
+  sprites_free(params);
+  cells_free(params);
+  for (y = 0; y < BENCH_MAP; y++)
+    free(params->map.map_data[y]);
+  free(params->map.map_data);
+  free(params->window_img.addr);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "bench_common.h"
+
+// --- Interlaced Rendering Benchmark ---
+//
+// Drives a full and an interlaced renderer along the same camera path and
+// compares the cost of the 3D view and its quality, as PSNR of the
+// interlaced frame against the full one.
+
+#define PSNR_IDENTICAL 99.0
+
+typedef struct s_segment {
+  const char *name;
+  int frames;
+  double turn; // Radians per frame
+  double walk; // World units per frame
+} t_segment;
+
+typedef struct s_result {
+  long full_us;
+  long interlaced_us;
+  double psnr_sum;
+  double psnr_min;
+} t_result;
+
+static double psnr(const t_img *a, const t_img *b) {
+  const unsigned char *pa = (const unsigned char *)a->addr;
+  const unsigned char *pb = (const unsigned char *)b->addr;
+  size_t i, n = (size_t)a->line_length * a->height;
+  double sum = 0.0, d, mse;
+
+  for (i = 0; i < n; i++) {
+    if (i % 4 == 3) // Skip the unused alpha byte
+      continue;
+    d = (double)pa[i] - pb[i];
+    sum += d * d;
+  }
+  mse = sum / (n / 4 * 3);
+  if (mse == 0.0)
+    return PSNR_IDENTICAL;
+  return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+static void step_camera(t_params *params, const t_segment *seg) {
+  params->player.direction =
+      normalize_angle(params->player.direction + seg->turn);
+  params->player.x += cos(params->player.direction) * seg->walk;
+  params->player.y += sin(params->player.direction) * seg->walk;
+}
+
+static void run_segment(t_params *full, t_params *inter, const t_segment *seg,
+                        t_result *res) {
+  static t_ray_hit full_hits[NUM_RAYS], inter_hits[NUM_RAYS];
+  long start;
+  double q;
+  int i;
+
+  res->psnr_min = PSNR_IDENTICAL;
+  for (i = 0; i < seg->frames; i++) {
+    step_camera(full, seg);
+    step_camera(inter, seg);
+    start = get_time_us();
+    cast_rays(full, full_hits);
+    render_3d_view(full, full_hits);
+    res->full_us += get_time_us() - start;
+    start = get_time_us();
+    interlace_render(inter, inter_hits);
+    res->interlaced_us += get_time_us() - start;
+    q = psnr(&full->window_img, &inter->window_img);
+    res->psnr_sum += q;
+    res->psnr_min = (q < res->psnr_min) ? q : res->psnr_min;
+  }
+}
+
+int main(void) {
+  static const t_segment path[] = {
+      {"still", 120, 0.0, 0.0},
+      {"slow turn", 240, 0.004, 0.0},
+      {"fast turn", 120, 0.05, 0.0},
+      {"slow walk", 120, 0.0, 1.0},
+  };
+  t_params full, inter;
+  t_result res;
+  unsigned long frames, cast;
+  size_t i;
+
+  if (bench_init(&full) || bench_init(&inter) || lighting_init(&full) ||
+      lighting_init(&inter))
+    return 1;
+  inter.interlace.enabled = true;
+  printf("interlace: %dx%d, 3D view only\n", WINDOW_WIDTH, WINDOW_HEIGHT);
+  printf("  %-10s %10s %10s %8s %10s %10s %8s\n", "segment", "full ms",
+         "inter ms", "speedup", "PSNR avg", "PSNR min", "cast");
+  for (i = 0; i < sizeof(path) / sizeof(path[0]); i++) {
+    ft_memset(&res, 0, sizeof(res));
+    frames = inter.interlace.stats.frames;
+    cast = inter.interlace.stats.cast_columns;
+    run_segment(&full, &inter, &path[i], &res);
+    frames = inter.interlace.stats.frames - frames;
+    cast = inter.interlace.stats.cast_columns - cast;
+    printf("  %-10s %10.3f %10.3f %7.2fx %7.2f dB %7.2f dB %7.1f%%\n",
+           path[i].name, res.full_us / 1000.0 / path[i].frames,
+           res.interlaced_us / 1000.0 / path[i].frames,
+           (double)res.full_us / res.interlaced_us,
+           res.psnr_sum / path[i].frames, res.psnr_min,
+           100.0 * cast / ((double)frames * NUM_RAYS));
+  }
+  bench_free(&full);
+  bench_free(&inter);
+  return 0;
+}
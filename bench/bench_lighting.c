@@ -0,0 +1,62 @@
+#include "bench_common.h"
+
+// --- Lightmap Benchmark ---
+//
+// Renders the wall and sprite passes over a pillared 48x48 map with a lamp
+// every few cells, with the lightmap on and off, and times the bake and
+// incremental relights.
+
+#define BENCH_FRAMES 200
+#define BENCH_ROUNDS 5
+#define BENCH_RELIGHTS 2000
+
+static long time_frames(t_params *params, t_ray_hit *ray_hits) {
+  long start = get_time_us();
+  int i;
+
+  for (i = 0; i < BENCH_FRAMES; i++) {
+    params->player.direction = normalize_angle(i * 2 * M_PI / BENCH_FRAMES);
+    cast_rays(params, ray_hits);
+    render_3d_view(params, ray_hits);
+    render_sprites(params, ray_hits);
+  }
+  return get_time_us() - start;
+}
+
+int main(void) {
+  static t_ray_hit ray_hits[NUM_RAYS];
+  t_params params;
+  long lit = LONG_MAX, unlit = LONG_MAX, t, start;
+  int i;
+
+  if (bench_init(&params))
+    return 1;
+  start = get_time_us();
+  if (lighting_init(&params))
+    return 1;
+  printf("lightmap: %dx%d map, %d lights, bake %.3f ms\n", BENCH_MAP,
+         BENCH_MAP, params.lighting.count, (get_time_us() - start) / 1000.0);
+
+  for (i = 0; i < BENCH_ROUNDS; i++) {
+    params.lighting.enabled = false;
+    t = time_frames(&params, ray_hits);
+    unlit = (t < unlit) ? t : unlit;
+    params.lighting.enabled = true;
+    t = time_frames(&params, ray_hits);
+    lit = (t < lit) ? t : lit;
+  }
+  printf("  %-24s %8.3f ms/frame\n", "unlit", unlit / 1000.0 / BENCH_FRAMES);
+  printf("  %-24s %8.3f ms/frame\n", "lit", lit / 1000.0 / BENCH_FRAMES);
+  printf("  %-24s %+7.2f %% (budget 5 %%)\n", "lighting overhead",
+         100.0 * (lit - unlit) / unlit);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_RELIGHTS; i++)
+    lighting_relight_cell(&params, 1 + i * 7 % (BENCH_MAP - 2),
+                          1 + i * 13 % (BENCH_MAP - 2));
+  printf("  %-24s %8.1f us\n", "relight cell",
+         (double)(get_time_us() - start) / BENCH_RELIGHTS);
+
+  bench_free(&params);
+  return 0;
+}
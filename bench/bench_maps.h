@@ -0,0 +1,138 @@
+#ifndef BENCH_MAPS_H
+# define BENCH_MAPS_H
+
+# include "../include/cub3d.h"
+
+// --- Synthetic Map Generators ---
+//
+// Square n x n maps of WALL and EMPTY cells, enclosed by walls, for
+// workloads the demo map cannot provide: short rays in mazes, long ones in
+// arenas and corridors, many near misses among pillars and rays crossing
+// most of a huge, nearly empty map. All are seeded, so a run is
+// repeatable.
+
+typedef struct s_bench_map_kind {
+  const char *name;
+  void (*generate)(char **rows, int n, unsigned int *seed);
+} t_bench_map_kind;
+
+static inline unsigned int bench_rand(unsigned int *seed) {
+  *seed = *seed * 1103515245u + 12345u;
+  return *seed >> 8;
+}
+
+static inline void bench_fill(char **rows, int n, char inside) {
+  int x, y;
+
+  for (y = 0; y < n; y++)
+    for (x = 0; x < n; x++)
+      rows[y][x] = (x == 0 || y == 0 || x == n - 1 || y == n - 1) ? WALL
+                                                                  : inside;
+}
+
+// Depth-first maze on the odd cells, carved with an explicit stack.
+static inline void bench_gen_maze(char **rows, int n, unsigned int *seed) {
+  static const int dirs[4][2] = {{2, 0}, {-2, 0}, {0, 2}, {0, -2}};
+  int cells = (n / 2) * (n / 2), top = 0, x, y, d, i, nx, ny;
+  int *stack = malloc(sizeof(*stack) * (cells + 1));
+  int open[4];
+
+  bench_fill(rows, n, WALL);
+  if (!stack)
+    return;
+  rows[1][1] = EMPTY;
+  stack[top++] = 1 * n + 1;
+  while (top > 0) {
+    x = stack[top - 1] % n;
+    y = stack[top - 1] / n;
+    for (d = 0, i = 0; i < 4; i++) {
+      nx = x + dirs[i][0];
+      ny = y + dirs[i][1];
+      if (nx > 0 && ny > 0 && nx < n - 1 && ny < n - 1 && rows[ny][nx] == WALL)
+        open[d++] = i;
+    }
+    if (d == 0) {
+      top--;
+      continue;
+    }
+    i = open[bench_rand(seed) % d];
+    rows[y + dirs[i][1] / 2][x + dirs[i][0] / 2] = EMPTY;
+    rows[y + dirs[i][1]][x + dirs[i][0]] = EMPTY;
+    stack[top++] = (y + dirs[i][1]) * n + x + dirs[i][0];
+  }
+  free(stack);
+}
+
+// An open floor with a few 2x2 blocks, one per 32x32 area on average.
+static inline void bench_gen_arena(char **rows, int n, unsigned int *seed) {
+  int i, x, y;
+
+  bench_fill(rows, n, EMPTY);
+  for (i = 0; i < (n / 32) * (n / 32) + 1; i++) {
+    x = 2 + bench_rand(seed) % (n - 5);
+    y = 2 + bench_rand(seed) % (n - 5);
+    rows[y][x] = rows[y][x + 1] = rows[y + 1][x] = rows[y + 1][x + 1] = WALL;
+  }
+}
+
+// Horizontal corridors three cells wide, with a gap every 64 cells or so.
+static inline void bench_gen_corridors(char **rows, int n, unsigned int *seed) {
+  int x, y;
+
+  bench_fill(rows, n, EMPTY);
+  for (y = 4; y < n - 1; y += 4)
+    for (x = 1; x < n - 1; x++)
+      rows[y][x] = (bench_rand(seed) % 64 == 0) ? EMPTY : WALL;
+}
+
+// Single-cell pillars on one cell in ten.
+static inline void bench_gen_pillars(char **rows, int n, unsigned int *seed) {
+  int x, y;
+
+  bench_fill(rows, n, EMPTY);
+  for (y = 1; y < n - 1; y++)
+    for (x = 1; x < n - 1; x++)
+      if (bench_rand(seed) % 10 == 0)
+        rows[y][x] = WALL;
+}
+
+// One wall cell in 2000: most rays run until a far wall or the border.
+static inline void bench_gen_sparse(char **rows, int n, unsigned int *seed) {
+  int x, y;
+
+  bench_fill(rows, n, EMPTY);
+  for (y = 1; y < n - 1; y++)
+    for (x = 1; x < n - 1; x++)
+      if (bench_rand(seed) % 2000 == 0)
+        rows[y][x] = WALL;
+}
+
+static const t_bench_map_kind g_bench_maps[] = {
+    {"maze", bench_gen_maze},         {"arena", bench_gen_arena},
+    {"corridors", bench_gen_corridors}, {"pillars", bench_gen_pillars},
+    {"sparse", bench_gen_sparse},
+};
+
+// Allocates n rows of n cells plus a terminator, or returns NULL.
+static inline char **bench_map_alloc(int n) {
+  char **rows = calloc(n, sizeof(*rows));
+  int y;
+
+  for (y = 0; rows && y < n; y++) {
+    rows[y] = malloc(n + 1);
+    if (!rows[y])
+      return NULL;
+    rows[y][n] = '\0';
+  }
+  return rows;
+}
+
+static inline void bench_map_free(char **rows, int n) {
+  int y;
+
+  for (y = 0; rows && y < n; y++)
+    free(rows[y]);
+  free(rows);
+}
+
+#endif
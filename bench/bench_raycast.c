@@ -0,0 +1,467 @@
+#include "bench_maps.h"
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#endif
+
+// --- Ray Traversal Benchmark ---
+//
+// Casts the rays of a frame from seeded poses in generated maps (see
+// bench_maps.h) with the game's caster and with candidate traversals,
+// reporting for each rays per second, grid cells visited per ray, cycles
+// per ray and how many hits disagree with an exact double-precision dda:
+//
+//   dual  find_horizontal/vertical_wall_intersection, as cast_ray does:
+//         each walks its own grid lines all the way to a wall
+//   dda   one walk through the cells the ray crosses (Amanatides-Woo)
+//   dda4  the same on four rays at a time in SSE2 lanes, in double
+//   sdf   dda that leaps across open space, as far as a Chebyshev
+//         distance-to-wall field says is clear
+//
+// Cycles are TSC ticks where there is a TSC, nanoseconds elsewhere. Maps
+// stop at 10^4 per side: the game keeps a byte per cell, so 10^5 would
+// need 10 GB. Every caster must match the reference on every ray, and the
+// bench fails otherwise. dda4 stays in double for that: float lanes lose
+// the order of the two next crossings near the far walls of 10^4 maps.
+
+#define BENCH_POSES 8
+#define BENCH_ROUNDS 5
+#define BENCH_SEED 42u
+#define SDF_MIN_SKIP 3 // Field values worth a leap of (value - 2) cells
+#define HIT_TOLERANCE 1.0 // World units two casters may disagree by
+
+typedef struct s_pose {
+  double x; // In cells
+  double y;
+  double direction;
+} t_pose;
+
+typedef struct s_scene {
+  t_params params; // map only, for the game's caster
+  char **rows;
+  int n;
+  unsigned char *field; // Chebyshev distance to the nearest wall, 255 max
+  t_pose poses[BENCH_POSES];
+} t_scene;
+
+typedef struct s_strategy {
+  const char *name;
+  // Casts the NUM_RAYS rays of a pose; distances in world units
+  void (*cast)(t_scene *g, const t_pose *pose, double *dist, long *visits);
+} t_strategy;
+
+static unsigned long long ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+static double ray_angle(const t_pose *pose, int i) {
+  return normalize_angle(pose->direction - PLAYER_FOV / 2.0 +
+                         i * (PLAYER_FOV / NUM_RAYS));
+}
+
+static bool is_wall(const t_scene *g, int x, int y) {
+  return (unsigned)x >= (unsigned)g->n || (unsigned)y >= (unsigned)g->n ||
+         g->rows[y][x] == WALL;
+}
+
+// --- dual: the game's caster ---
+
+// Grid lines of one axis a pass crossed going from from to end.
+static long lines_crossed(double from, double end) {
+  return labs((long)floor(end / TILE_SIZE) - (long)floor(from / TILE_SIZE));
+}
+
+// Where the ray leaves the map, for passes that found no wall.
+static t_fpoint map_exit(const t_scene *g, double x, double y, double a) {
+  double dx = cos(a), dy = sin(a), side = (double)g->n * TILE_SIZE;
+  double sx = (dx > 0) ? (side - x) / dx : (dx < 0) ? -x / dx : INFINITY;
+  double sy = (dy > 0) ? (side - y) / dy : (dy < 0) ? -y / dy : INFINITY;
+  double s = fmin(sx, sy);
+
+  return (t_fpoint){x + dx * s, y + dy * s};
+}
+
+static void cast_dual(t_scene *g, const t_pose *pose, double *dist,
+                      long *visits) {
+  t_params *params = &g->params;
+  t_fpoint h, v, out;
+  double a, hd, vd;
+  int i;
+
+  params->player.x = pose->x * TILE_SIZE;
+  params->player.y = pose->y * TILE_SIZE;
+  for (i = 0; i < NUM_RAYS; i++) {
+    a = ray_angle(pose, i);
+    h = find_horizontal_wall_intersection(params, a);
+    v = find_vertical_wall_intersection(params, a);
+    hd = calculate_euclidean_distance(params->player.x, params->player.y, h.x,
+                                      h.y);
+    vd = calculate_euclidean_distance(params->player.x, params->player.y, v.x,
+                                      v.y);
+    dist[i] = (hd < vd) ? hd : vd;
+    out = map_exit(g, params->player.x, params->player.y, a);
+    *visits += lines_crossed(params->player.y, (hd < INT_MAX) ? h.y : out.y) +
+               lines_crossed(params->player.x, (vd < INT_MAX) ? v.x : out.x);
+  }
+}
+
+// --- dda ---
+
+typedef struct s_walk {
+  int x, y;         // Cell
+  int step_x, step_y;
+  double side_x;    // Ray distance to the next vertical grid line
+  double side_y;    // And to the next horizontal one
+  double delta_x;   // Ray distance between vertical grid lines
+  double delta_y;
+} t_walk;
+
+// Starts a walk at distance t along the ray from (px, py), in cells.
+static void walk_start(t_walk *w, double px, double py, double dx, double dy,
+                       double t) {
+  double x = px + dx * t, y = py + dy * t;
+
+  w->x = (int)x;
+  w->y = (int)y;
+  w->delta_x = (dx == 0.0) ? 1e30 : fabs(1.0 / dx);
+  w->delta_y = (dy == 0.0) ? 1e30 : fabs(1.0 / dy);
+  w->step_x = (dx < 0.0) ? -1 : 1;
+  w->step_y = (dy < 0.0) ? -1 : 1;
+  w->side_x = t + ((dx < 0.0) ? x - w->x : w->x + 1.0 - x) * w->delta_x;
+  w->side_y = t + ((dy < 0.0) ? y - w->y : w->y + 1.0 - y) * w->delta_y;
+}
+
+// Moves into the next cell the ray crosses; returns the distance to it.
+static inline double walk_step(t_walk *w) {
+  double t;
+
+  if (w->side_x < w->side_y) {
+    t = w->side_x;
+    w->side_x += w->delta_x;
+    w->x += w->step_x;
+  } else {
+    t = w->side_y;
+    w->side_y += w->delta_y;
+    w->y += w->step_y;
+  }
+  return t;
+}
+
+static void cast_dda(t_scene *g, const t_pose *pose, double *dist,
+                     long *visits) {
+  double a, t;
+  t_walk w;
+  int i;
+
+  for (i = 0; i < NUM_RAYS; i++) {
+    a = ray_angle(pose, i);
+    walk_start(&w, pose->x, pose->y, cos(a), sin(a), 0.0);
+    do {
+      t = walk_step(&w);
+      (*visits)++;
+    } while (!is_wall(g, w.x, w.y));
+    dist[i] = t * TILE_SIZE;
+  }
+}
+
+// --- dda4 ---
+
+#ifdef __SSE2__
+# include <emmintrin.h>
+
+// One step of two lanes: advances the side distances the step choice
+// picks and returns the distance reached. x_first is all ones per lane
+// where the vertical grid line comes first.
+static inline __m128d step_pair(__m128d *side_x, __m128d *side_y,
+                                __m128d delta_x, __m128d delta_y,
+                                __m128d active, __m128d *x_first) {
+  __m128d hit_t;
+
+  *x_first = _mm_cmplt_pd(*side_x, *side_y);
+  hit_t = _mm_or_pd(_mm_and_pd(*x_first, *side_x),
+                    _mm_andnot_pd(*x_first, *side_y));
+  *side_x = _mm_add_pd(*side_x,
+                       _mm_and_pd(_mm_and_pd(*x_first, active), delta_x));
+  *side_y = _mm_add_pd(*side_y,
+                       _mm_and_pd(_mm_andnot_pd(*x_first, active), delta_y));
+  return hit_t;
+}
+
+// Packs the 64-bit lane masks of two pairs into four 32-bit ones.
+static inline __m128i pack_masks(__m128d lo, __m128d hi) {
+  return _mm_castps_si128(_mm_shuffle_ps(_mm_castpd_ps(lo), _mm_castpd_ps(hi),
+                                         _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+// Four walks in lockstep, as two pairs of double lanes: the step choice
+// and advance are vector ops doing exactly what walk_step does, the map
+// lookups scalar (SSE2 has no gather). Finished lanes stay masked off
+// until the slowest one hits.
+static void cast_dda4_packet(t_scene *g, const t_pose *pose, int first,
+                             double *dist, long *visits) {
+  double sx[4] __attribute__((aligned(16))), sy[4] __attribute__((aligned(16)));
+  double dx[4] __attribute__((aligned(16))), dy[4] __attribute__((aligned(16)));
+  double t[4] __attribute__((aligned(16)));
+  long long live64[4] __attribute__((aligned(16)));
+  int cx[4] __attribute__((aligned(16))), cy[4] __attribute__((aligned(16)));
+  int px[4] __attribute__((aligned(16))), py[4] __attribute__((aligned(16)));
+  int live[4] __attribute__((aligned(16)));
+  __m128d side_x[2], side_y[2], delta_x[2], delta_y[2], x_first[2], active[2];
+  __m128i map_x, map_y, step_x, step_y, x_mask, live_mask;
+  t_walk w;
+  int l, h, left = 4;
+
+  for (l = 0; l < 4; l++) {
+    double a = ray_angle(pose, first + l);
+
+    walk_start(&w, pose->x, pose->y, cos(a), sin(a), 0.0);
+    sx[l] = w.side_x;
+    sy[l] = w.side_y;
+    dx[l] = w.delta_x;
+    dy[l] = w.delta_y;
+    cx[l] = w.x;
+    cy[l] = w.y;
+    px[l] = w.step_x;
+    py[l] = w.step_y;
+    live[l] = -1;
+    live64[l] = -1;
+  }
+  for (h = 0; h < 2; h++) {
+    side_x[h] = _mm_load_pd(sx + 2 * h);
+    side_y[h] = _mm_load_pd(sy + 2 * h);
+    delta_x[h] = _mm_load_pd(dx + 2 * h);
+    delta_y[h] = _mm_load_pd(dy + 2 * h);
+    active[h] = _mm_castsi128_pd(_mm_load_si128((__m128i *)(live64 + 2 * h)));
+  }
+  map_x = _mm_load_si128((__m128i *)cx);
+  map_y = _mm_load_si128((__m128i *)cy);
+  step_x = _mm_load_si128((__m128i *)px);
+  step_y = _mm_load_si128((__m128i *)py);
+  live_mask = _mm_load_si128((__m128i *)live);
+  while (left > 0) {
+    for (h = 0; h < 2; h++)
+      _mm_store_pd(t + 2 * h, step_pair(&side_x[h], &side_y[h], delta_x[h],
+                                        delta_y[h], active[h], &x_first[h]));
+    x_mask = pack_masks(x_first[0], x_first[1]);
+    map_x = _mm_add_epi32(
+        map_x, _mm_and_si128(_mm_and_si128(x_mask, live_mask), step_x));
+    map_y = _mm_add_epi32(
+        map_y, _mm_and_si128(_mm_andnot_si128(x_mask, live_mask), step_y));
+    _mm_store_si128((__m128i *)cx, map_x);
+    _mm_store_si128((__m128i *)cy, map_y);
+    for (l = 0; l < 4; l++) {
+      if (!live[l])
+        continue;
+      (*visits)++;
+      if (is_wall(g, cx[l], cy[l])) {
+        dist[first + l] = t[l] * TILE_SIZE;
+        live[l] = 0;
+        live64[l] = 0;
+        left--;
+      }
+    }
+    live_mask = _mm_load_si128((__m128i *)live);
+    for (h = 0; h < 2; h++)
+      active[h] = _mm_castsi128_pd(_mm_load_si128((__m128i *)(live64 + 2 * h)));
+  }
+}
+
+static void cast_dda4(t_scene *g, const t_pose *pose, double *dist,
+                      long *visits) {
+  int i;
+
+  for (i = 0; i + 4 <= NUM_RAYS; i += 4)
+    cast_dda4_packet(g, pose, i, dist, visits);
+}
+#endif
+
+// --- sdf ---
+
+// Two chamfer passes with unit weights over all eight neighbours give the
+// exact Chebyshev distance to the nearest wall.
+static int field_build(t_scene *g) {
+  int n = g->n, x, y, d;
+  unsigned char *f = malloc((size_t)n * n);
+
+  if (!f)
+    return -1;
+  for (y = 0; y < n; y++)
+    for (x = 0; x < n; x++) {
+      d = (g->rows[y][x] == WALL) ? 0 : 255;
+      if (d && y > 0) {
+        d = fmin(d, f[(y - 1) * n + x] + 1);
+        d = (x > 0) ? fmin(d, f[(y - 1) * n + x - 1] + 1) : d;
+        d = (x < n - 1) ? fmin(d, f[(y - 1) * n + x + 1] + 1) : d;
+      }
+      f[y * n + x] = (d && x > 0) ? fmin(d, f[y * n + x - 1] + 1) : d;
+    }
+  for (y = n - 1; y >= 0; y--)
+    for (x = n - 1; x >= 0; x--) {
+      d = f[y * n + x];
+      if (d && y < n - 1) {
+        d = fmin(d, f[(y + 1) * n + x] + 1);
+        d = (x > 0) ? fmin(d, f[(y + 1) * n + x - 1] + 1) : d;
+        d = (x < n - 1) ? fmin(d, f[(y + 1) * n + x + 1] + 1) : d;
+      }
+      f[y * n + x] = (d && x < n - 1) ? fmin(d, f[y * n + x + 1] + 1) : d;
+    }
+  g->field = f;
+  return 0;
+}
+
+// From anywhere in a cell of field value d, every cell within d - 1 is
+// open; leaping d - 2 keeps one cell of margin for a position rounded into
+// the neighbouring cell.
+static void cast_sdf(t_scene *g, const t_pose *pose, double *dist,
+                     long *visits) {
+  double a, dx, dy, reach, t;
+  int i, d;
+  t_walk w;
+
+  for (i = 0; i < NUM_RAYS; i++) {
+    a = ray_angle(pose, i);
+    dx = cos(a);
+    dy = sin(a);
+    reach = fmax(fabs(dx), fabs(dy));
+    t = 0.0; // Where the ray entered the current cell
+    walk_start(&w, pose->x, pose->y, dx, dy, t);
+    while (1) {
+      (*visits)++;
+      d = g->field[w.y * g->n + w.x];
+      if (d >= SDF_MIN_SKIP) {
+        t += (d - 2) / reach;
+        walk_start(&w, pose->x, pose->y, dx, dy, t);
+        continue;
+      }
+      t = walk_step(&w);
+      if (is_wall(g, w.x, w.y))
+        break;
+    }
+    dist[i] = t * TILE_SIZE;
+  }
+}
+
+static const t_strategy g_strategies[] = {
+    {"dual", cast_dual},
+    {"dda", cast_dda},
+#ifdef __SSE2__
+    {"dda4", cast_dda4},
+#endif
+    {"sdf", cast_sdf},
+};
+
+// --- Driver ---
+
+static int scene_init(t_scene *g, const t_bench_map_kind *kind, int n) {
+  unsigned int seed = BENCH_SEED;
+  int i, x, y;
+
+  ft_memset(g, 0, sizeof(*g));
+  g->n = n;
+  g->rows = bench_map_alloc(n);
+  if (!g->rows)
+    return -1;
+  kind->generate(g->rows, n, &seed);
+  g->params.map.map_data = g->rows;
+  g->params.map.rows = n;
+  g->params.map.cols = n;
+  for (i = 0; i < BENCH_POSES; i++) {
+    do {
+      x = 1 + bench_rand(&seed) % (n - 2);
+      y = 1 + bench_rand(&seed) % (n - 2);
+    } while (g->rows[y][x] != EMPTY);
+    g->poses[i].x = x + 0.25 + (bench_rand(&seed) % 512) / 1024.0;
+    g->poses[i].y = y + 0.25 + (bench_rand(&seed) % 512) / 1024.0;
+    g->poses[i].direction = (bench_rand(&seed) % 3600) * (2.0 * M_PI / 3600);
+  }
+  return field_build(g);
+}
+
+static void scene_free(t_scene *g) {
+  bench_map_free(g->rows, g->n);
+  free(g->field);
+}
+
+// Best of BENCH_ROUNDS over all poses, in microseconds and ticks.
+static void run_strategy(t_scene *g, const t_strategy *s, double *dist,
+                         long *visits, long *best_us,
+                         unsigned long long *best_ticks) {
+  unsigned long long t0;
+  long start, us;
+  int round, p;
+
+  *best_us = LONG_MAX;
+  for (round = 0; round < BENCH_ROUNDS; round++) {
+    *visits = 0;
+    start = get_time_us();
+    t0 = ticks();
+    for (p = 0; p < BENCH_POSES; p++)
+      s->cast(g, &g->poses[p], dist + p * NUM_RAYS, visits);
+    us = get_time_us() - start;
+    if (us < *best_us) {
+      *best_us = us;
+      *best_ticks = ticks() - t0;
+    }
+  }
+}
+
+// Benches every strategy on one scene; returns the rays that disagree with
+// the reference dda.
+static long run_scene(t_scene *g, const char *name, double *ref,
+                      double *dist) {
+  const long rays = (long)BENCH_POSES * NUM_RAYS;
+  unsigned long long best_ticks = 0;
+  long visits, best_us, off, i, total = 0;
+  size_t s;
+  int p;
+
+  for (p = 0; p < BENCH_POSES; p++)
+    cast_dda(g, &g->poses[p], ref + p * NUM_RAYS, &visits);
+  for (s = 0; s < sizeof(g_strategies) / sizeof(g_strategies[0]); s++) {
+    run_strategy(g, &g_strategies[s], dist, &visits, &best_us, &best_ticks);
+    for (off = 0, i = 0; i < rays; i++)
+      off += fabs(dist[i] - ref[i]) > HIT_TOLERANCE;
+    printf("  %-10s %6d %-6s %9.2f %10.1f %11.0f %8.2f%%\n", name, g->n,
+           g_strategies[s].name, rays / (double)(best_us ? best_us : 1),
+           (double)visits / rays, (double)best_ticks / rays,
+           100.0 * off / rays);
+    total += off;
+  }
+  return total;
+}
+
+int main(void) {
+  static const int sizes[] = {100, 1000, 10000};
+  double *ref = malloc(sizeof(*ref) * BENCH_POSES * NUM_RAYS);
+  double *dist = malloc(sizeof(*dist) * BENCH_POSES * NUM_RAYS);
+  long off = 0;
+  size_t k, s;
+  t_scene g;
+
+  if (!ref || !dist)
+    return 1;
+  printf("raycast: %d poses x %d rays, best of %d\n", BENCH_POSES, NUM_RAYS,
+         BENCH_ROUNDS);
+  printf("  %-10s %6s %-6s %9s %10s %11s %9s\n", "map", "side", "cast",
+         "Mrays/s", "cells/ray", "cycles/ray", "mismatch");
+  for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    for (k = 0; k < sizeof(g_bench_maps) / sizeof(g_bench_maps[0]); k++) {
+      if (scene_init(&g, &g_bench_maps[k], sizes[s]) != 0) {
+        perror("bench_raycast");
+        return 1;
+      }
+      off += run_scene(&g, g_bench_maps[k].name, ref, dist);
+      scene_free(&g);
+    }
+  free(ref);
+  free(dist);
+  if (off)
+    fprintf(stderr, "raycast: %ld hits disagree with the exact dda\n", off);
+  return off != 0;
+}
@@ -0,0 +1,131 @@
+#include "../include/cub3d.h"
+
+// --- Spatial Grid Benchmark ---
+//
+// 100k entities scattered over a 1000x1000 cell map: bulk insert, a frame
+// of random-walk moves, radius queries and view-cone queries (the sprite
+// culling query), each cross-checked against a brute-force scan, then
+// removal of half of them.
+
+#define BENCH_ENTITIES 100000
+#define BENCH_MAP_CELLS 1000
+#define BENCH_QUERIES 10000
+#define BENCH_CHECKED 100
+#define BENCH_RADIUS (4.0 * TILE_SIZE)
+
+static unsigned int g_seed = 0x9E3779B9u;
+
+static double frand(double max) {
+  g_seed ^= g_seed << 13;
+  g_seed ^= g_seed >> 17;
+  g_seed ^= g_seed << 5;
+  return (g_seed / 4294967296.0) * max;
+}
+
+static int brute_radius(double *pos, double x, double y, double r) {
+  int i, found = 0;
+
+  for (i = 0; i < BENCH_ENTITIES; i++) {
+    double dx = pos[2 * i] - x, dy = pos[2 * i + 1] - y;
+    found += (dx * dx + dy * dy <= r * r);
+  }
+  return found;
+}
+
+static int brute_frustum(double *pos, const t_grid_frustum *f) {
+  double fx = cos(f->dir), fy = sin(f->dir);
+  double lx = -sin(f->dir - f->half_fov), ly = cos(f->dir - f->half_fov);
+  double rx = sin(f->dir + f->half_fov), ry = -cos(f->dir + f->half_fov);
+  int i, found = 0;
+
+  for (i = 0; i < BENCH_ENTITIES; i++) {
+    double vx = pos[2 * i] - f->x, vy = pos[2 * i + 1] - f->y;
+    double fwd = vx * fx + vy * fy;
+    found += fwd >= -f->margin && fwd <= f->far + f->margin &&
+             vx * lx + vy * ly >= -f->margin && vx * rx + vy * ry >= -f->margin;
+  }
+  return found;
+}
+
+static void report(const char *name, long us, long ops) {
+  printf("  %-28s %9.3f ms  %8.1f ns/op\n", name, us / 1000.0,
+         us * 1000.0 / ops);
+}
+
+static t_grid_frustum random_view(double world) {
+  return (t_grid_frustum){frand(world), frand(world), frand(2 * M_PI),
+                          PLAYER_FOV / 2.0, MAX_VISIBLE_DISTANCE,
+                          TILE_SIZE / 2.0};
+}
+
+int main(void) {
+  double world = (double)BENCH_MAP_CELLS * TILE_SIZE;
+  t_spatial_grid grid;
+  t_grid_frustum view;
+  static int out[BENCH_ENTITIES];
+  double *pos = malloc(2 * BENCH_ENTITIES * sizeof(double));
+  long start, hits = 0;
+  int i, n, errors = 0;
+
+  if (!pos || grid_init(&grid, BENCH_MAP_CELLS, BENCH_MAP_CELLS, TILE_SIZE))
+    return 1;
+  printf("spatial grid: %d entities, %dx%d cells\n", BENCH_ENTITIES,
+         BENCH_MAP_CELLS, BENCH_MAP_CELLS);
+  for (i = 0; i < 2 * BENCH_ENTITIES; i++)
+    pos[i] = frand(world);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_ENTITIES; i++)
+    grid_insert(&grid, i, pos[2 * i], pos[2 * i + 1]);
+  report("insert", get_time_us() - start, BENCH_ENTITIES);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_ENTITIES; i++) {
+    pos[2 * i] = fmin(fmax(pos[2 * i] + frand(16.0) - 8.0, 0.0), world - 1);
+    pos[2 * i + 1] =
+        fmin(fmax(pos[2 * i + 1] + frand(16.0) - 8.0, 0.0), world - 1);
+    grid_move(&grid, i, pos[2 * i], pos[2 * i + 1]);
+  }
+  report("move (one frame)", get_time_us() - start, BENCH_ENTITIES);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_QUERIES; i++)
+    hits += grid_query_radius(&grid, frand(world), frand(world), BENCH_RADIUS,
+                              out, BENCH_ENTITIES);
+  report("radius query", get_time_us() - start, BENCH_QUERIES);
+  printf("  %-28s %9.2f\n", "  avg matches", (double)hits / BENCH_QUERIES);
+
+  hits = 0;
+  start = get_time_us();
+  for (i = 0; i < BENCH_QUERIES; i++) {
+    view = random_view(world);
+    hits += grid_query_frustum(&grid, &view, out, BENCH_ENTITIES);
+  }
+  report("frustum query", get_time_us() - start, BENCH_QUERIES);
+  printf("  %-28s %9.2f\n", "  avg matches", (double)hits / BENCH_QUERIES);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_CHECKED; i++) {
+    double x = frand(world), y = frand(world);
+
+    n = grid_query_radius(&grid, x, y, BENCH_RADIUS, out, BENCH_ENTITIES);
+    errors += (n != brute_radius(pos, x, y, BENCH_RADIUS));
+    view = random_view(world);
+    n = grid_query_frustum(&grid, &view, out, BENCH_ENTITIES);
+    errors += (n != brute_frustum(pos, &view));
+  }
+  report("brute-force check (pair)", get_time_us() - start, BENCH_CHECKED);
+
+  start = get_time_us();
+  for (i = 0; i < BENCH_ENTITIES; i += 2)
+    grid_remove(&grid, i);
+  report("remove (half)", get_time_us() - start, BENCH_ENTITIES / 2);
+  errors += (grid.count != BENCH_ENTITIES / 2);
+
+  grid_free(&grid);
+  free(pos);
+  if (errors)
+    fprintf(stderr, "spatial grid: %d mismatches against brute force\n",
+            errors);
+  return errors != 0;
+}
@@ -0,0 +1,98 @@
+#include "bench_common.h"
+
+// --- Texture Format Benchmark ---
+//
+// Walls the player in a single cell so close-up walls fill the whole view,
+// then times the 3D view sampling 32-bit and RGB565 wall textures, with
+// the built-in TEXTURE_SIZE set and with a large set that no longer fits
+// in cache.
+
+#define BENCH_FRAMES 120
+#define BENCH_ROUNDS 3
+#define BENCH_BIG_TEXTURE 1024
+
+// Upscales each built-in texture to size with per-texel noise.
+static int make_big_textures(t_params *params, int size) {
+  t_texture big;
+  unsigned int noise, texel;
+  int i, x, y, sx, sy;
+
+  for (i = 0; i < WALL_TEXTURES; i++) {
+    if (texture_alloc(&big, size, size) != 0)
+      return -1;
+    for (x = 0; x < size; x++)
+      for (y = 0; y < size; y++) {
+        sx = x * TEXTURE_SIZE / size;
+        sy = y * TEXTURE_SIZE / size;
+        texel = params->wall_textures[i].texels[sx * TEXTURE_SIZE + sy];
+        noise = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^
+                (unsigned int)i * 83492791u;
+        big.texels[x * size + y] = shade_color(texel, 200 + noise % 57);
+      }
+    texture_free(&params->wall_textures[i]);
+    texture16_free(&params->wall_textures16[i]);
+    params->wall_textures[i] = big;
+    if (texture_pack_565(&params->wall_textures16[i], &big) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+static long time_frames(t_params *params, t_ray_hit *ray_hits) {
+  long start = get_time_us();
+  int i;
+
+  for (i = 0; i < BENCH_FRAMES; i++) {
+    params->player.direction = normalize_angle(i * 2 * M_PI / BENCH_FRAMES);
+    cast_rays(params, ray_hits);
+    render_3d_view(params, ray_hits);
+  }
+  return get_time_us() - start;
+}
+
+static void run(t_params *params, t_ray_hit *ray_hits) {
+  long t32 = LONG_MAX, t16 = LONG_MAX, t;
+  size_t texels = 0;
+  int i;
+
+  for (i = 0; i < WALL_TEXTURES; i++)
+    texels += (size_t)params->wall_textures[i].width *
+              params->wall_textures[i].height;
+  for (i = 0; i < BENCH_ROUNDS; i++) {
+    params->textures_565 = false;
+    t = time_frames(params, ray_hits);
+    t32 = (t < t32) ? t : t32;
+    params->textures_565 = true;
+    t = time_frames(params, ray_hits);
+    t16 = (t < t16) ? t : t16;
+  }
+  printf("  %4dx%-4d 32-bit %7.0f KiB %8.3f ms/frame\n",
+         params->wall_textures[0].width, params->wall_textures[0].height,
+         texels * 4 / 1024.0, t32 / 1000.0 / BENCH_FRAMES);
+  printf("  %9s RGB565 %7.0f KiB %8.3f ms/frame (%+.1f %%)\n", "",
+         texels * 2 / 1024.0, t16 / 1000.0 / BENCH_FRAMES,
+         100.0 * (t16 - t32) / t32);
+}
+
+int main(void) {
+  static t_ray_hit ray_hits[NUM_RAYS];
+  t_params params;
+  int cx, cy, dx, dy;
+
+  if (bench_init(&params))
+    return 1;
+  params.sky_enabled = false;
+  cx = (int)(params.player.x / TILE_SIZE);
+  cy = (int)(params.player.y / TILE_SIZE);
+  for (dy = -1; dy <= 1; dy++)
+    for (dx = -1; dx <= 1; dx++)
+      if (dx || dy)
+        cell_set(&params, cx + dx, cy + dy, WALL);
+  printf("textures: %d wall textures, close-up walls\n", WALL_TEXTURES);
+  run(&params, ray_hits);
+  if (make_big_textures(&params, BENCH_BIG_TEXTURE) != 0)
+    return 1;
+  run(&params, ray_hits);
+  bench_free(&params);
+  return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef COUNTERS_H
+# define COUNTERS_H
+
+# include <stdio.h>
+
+/*
+ * Hot-path work counters, built only with -D COUNTERS (make counters):
+ * grid steps of find_*_wall_intersection per ray, pixels the column
+ * renderer and the minimap write and texels the column renderer reads.
+ * The hot loops bump plain globals; frames are only rendered under
+ * world_lock, so no atomics are needed. COUNT_FRAME at the start of a
+ * frame closes the previous one into the run totals and, with
+ * --counters, one CSV row. Without COUNTERS every macro is a no-op.
+ */
+# define COUNT_HIST_BUCKETS 12
+# define COUNT_DEFAULT_PATH "cub3d_counters.csv"
+
+# ifdef COUNTERS
+
+/* One frame; hist[k] counts rays of 2^(k-1) to 2^k - 1 steps, hist[0]
+ * rays of none and the last bucket everything longer. */
+typedef struct s_count_frame
+{
+	unsigned long	rays;
+	unsigned long	steps;
+	unsigned int	steps_min;
+	unsigned int	steps_max;
+	unsigned long	hist[COUNT_HIST_BUCKETS];
+	unsigned long	view_pixels;
+	unsigned long	texels;
+	unsigned long	minimap_pixels;
+}				t_count_frame;
+
+typedef struct s_counters
+{
+	unsigned int	ray_steps;
+	t_count_frame	frame;
+	t_count_frame	total;
+	unsigned long	frames;
+	FILE			*csv;
+}				t_counters;
+
+extern t_counters	g_counters;
+
+int				count_open(const char *path);
+void			count_ray(void);
+void			count_frame(void);
+void			count_report(FILE *out);
+void			count_close(void);
+
+#  define COUNT_STEP() (g_counters.ray_steps++)
+#  define COUNT_RAY() count_ray()
+#  define COUNT_VIEW(px, tx) (g_counters.frame.view_pixels += (px), \
+	g_counters.frame.texels += (tx))
+#  define COUNT_MINIMAP(px) (g_counters.frame.minimap_pixels += (px))
+#  define COUNT_FRAME() count_frame()
+#  define COUNT_REPORT(out) count_report(out)
+#  define COUNT_CLOSE() count_close()
+
+# else
+
+#  define COUNT_STEP() ((void)0)
+#  define COUNT_RAY() ((void)0)
+#  define COUNT_VIEW(px, tx) ((void)0)
+#  define COUNT_MINIMAP(px) ((void)0)
+#  define COUNT_FRAME() ((void)0)
+#  define COUNT_REPORT(out) ((void)0)
+#  define COUNT_CLOSE() ((void)0)
+
+# endif
+
+#endif
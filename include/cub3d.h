@@ -8,6 +8,7 @@
 # include <fcntl.h>
 # include <limits.h>
 # include <math.h>
+# include <pthread.h>
 # include <stdbool.h>
 # include <stdio.h>
 # include <stdlib.h>
@@ -19,6 +20,9 @@
 # include "../mlx/mlx.h"
 # include "garbage_collector.h"
 # include "queue.h"
+# include "counters.h"
+# include "profiler.h"
+# include "spatial_grid.h"
 
 /********** No Magic Numbers **********/
 
@@ -60,6 +64,8 @@ typedef enum e_map_element
 	PLAYER_SOUTH = 'S',
 	PLAYER_EAST = 'E',
 	PLAYER_WEST = 'W',
+	SPRITE = '2',
+	DOOR = 'D',
 	VISITED = 'X', // Used in flood fill
 	FILL = 'F'     // Used to replace spaces for flood fill
 }				t_map_element;
@@ -154,11 +160,102 @@ void			parse_scene_element(t_textures *textures, char *identifier,
 # define RESOLUTION 1024
 # define TILE_SIZE 64
 # define TEXTURE_SIZE 64
-# define MOVE_SPEED 40
-# define ROTATE_SPEED 0.2
+# define PLAYER_WALK_SPEED (TILE_SIZE * 3.0) // World units per second
+# define PLAYER_TURN_SPEED (M_PI * 0.75)     // Radians per second
+# define SIM_HZ 120
+# define SIM_TICK_US (1000000L / SIM_HZ)
+# define SIM_MAX_TICKS 12 // Per update; older backlog is dropped
 # define HORIZONTAL 0
 # define VERTICAL 1
 
+/* Cohen-Sutherland region codes */
+# define OUT_INSIDE 0
+# define OUT_LEFT 1
+# define OUT_RIGHT 2
+# define OUT_TOP 4
+# define OUT_BOTTOM 8
+
+/* Segments per XDrawSegments request (window_draw_segments caps at 256) */
+# define SEGMENT_BATCH 256
+
+# define MAP_SCALE 10
+# define NUM_RAYS WINDOW_WIDTH
+# define PLAYER_FOV (M_PI / 3.0) // 60 degrees
+# ifndef FRAME_RATE_CAP // e.g. make CFLAGS+=-DFRAME_RATE_CAP=144
+#  define FRAME_RATE_CAP 60
+# endif
+# ifndef PACER_SPIN_NS // Busy-wait tail before each deadline; 0 disables
+#  define PACER_SPIN_NS 200000L
+# endif
+# define HEADLESS_DEFAULT_FRAMES 600
+# define HEADLESS_WARMUP_FRAMES 30 // Rendered before timing starts
+# define HEADLESS_ALIGN 64
+# define REPLAY_MAGIC "C3RP"
+# define REPLAY_VERSION 1
+# define REPLAY_POSE_EPSILON 1e-3 // World units and radians
+# define MAX_VISIBLE_DISTANCE (15.0 * TILE_SIZE)
+# define MINIMAP_RAY_STEP 8
+# define MINIMAP_SIZE 200
+# define MINIMAP_LAYER_MARGIN 40
+# define MINIMAP_LOD_LEVELS 6
+# define MINIMAP_FAN_ALPHA 96
+
+/* Sprites */
+# define SPRITE_TEXTURES 2
+# define SPRITE_NEAR_PLANE 1.0
+# define ZBUFFER_TILE 16
+# define TEXTURE_TRANSPARENT 0xFF000000
+
+/* Lightmap levels (0..LIGHT_FULL) and reach in cells */
+# define LIGHT_FULL 255
+# define LIGHT_AMBIENT 64
+# define LIGHT_LAMP_RADIUS 6
+# define LIGHT_MAX_RADIUS 8
+
+/* Post-processing stages (enable bits) and their parameters */
+# define POST_FOG 1
+# define POST_VIGNETTE 2
+# define POST_GAMMA 4
+# define POST_ALL (POST_FOG | POST_VIGNETTE | POST_GAMMA)
+# define FOG_START (3.0 * TILE_SIZE)
+# define FOG_COLOR 0x283038
+# define VIGNETTE_STRENGTH 0.35
+# define POST_GAMMA_CURVE 1.3
+# define POST_CALIBRATION_RUNS 20
+
+/* Walls */
+# define WALL_TEXTURES 5
+# define INTERLACE_MAX_MOVE (TILE_SIZE / 8.0)
+// One sky texel per screen column: a full turn spans 2 pi / FOV screens
+# define SKY_WIDTH ((int)(2.0 * M_PI / PLAYER_FOV * NUM_RAYS + 0.5))
+# define SKY_HEIGHT (WINDOW_HEIGHT / 2)
+# define PALETTE_COLORS 256
+# define PALETTE_LEVELS 32
+# define SPAN_MAX_COLUMNS 32
+
+/* Doors */
+# define DOOR_SLIDE_SECONDS 0.6
+
+/* Framebuffers rotated between the render and present threads (2 or 3) */
+# define PRESENT_BUFFERS 3
+// Slack the render thread leaves between a frame's expected end (mean
+// render time plus four mean deviations) and the tick that presents it
+# define PRESENT_MARGIN_US 1000L
+
+/********** Colors **********/
+
+# define C_BLACK 0x000000
+# define C_WHITE 0xFFFFFF
+# define C_RED 0xFF0000
+# define C_GREEN 0x00FF00
+# define C_BLUE 0x0000FF
+# define C_YELLOW 0xFFFF00
+# define C_GRAY 0x808080
+# define C_DARK_GRAY 0x404040
+# define C_CEILING 0x303060
+# define C_FLOOR 0x604040
+# define C_DOOR 0x8B5A2B
+
 typedef struct s_point
 {
 	int			x;
@@ -171,6 +268,17 @@ typedef struct s_fpoint
 	float		y;
 }				t_fpoint;
 
+typedef struct s_fan
+{
+	t_fpoint		center;
+	const t_fpoint	*rim;
+	int				count;
+	unsigned int	color;
+	int				alpha;
+	int				clip_w;
+	int				clip_h;
+}				t_fan;
+
 typedef struct s_img
 {
 	void		*img;
@@ -183,6 +291,68 @@ typedef struct s_img
 	int			height;
 }				t_img;
 
+/**
+ * Texture stored column-major (texels[x * height + y]) so that vertical
+ * spans read consecutive memory. Texels with TEXTURE_TRANSPARENT set in
+ * the alpha byte are skipped by the sprite renderer.
+ */
+typedef struct s_texture
+{
+	unsigned int	*texels;
+	int				width;
+	int				height;
+}				t_texture;
+
+/**
+ * RGB565 copy of a t_texture, same layout at half the size. Texels expand
+ * back to 0xRRGGBB as lo[t & 0xFF] | hi[t >> 8] with a t_rgb565_lut.
+ */
+typedef struct s_texture16
+{
+	unsigned short	*texels;
+	int				width;
+	int				height;
+}				t_texture16;
+
+typedef struct s_rgb565_lut
+{
+	unsigned int	lo[256];
+	unsigned int	hi[256];
+}				t_rgb565_lut;
+
+typedef struct s_sprite
+{
+	double		x;
+	double		y;
+	int			texture;
+	double		depth;
+	double		lateral;
+}				t_sprite;
+
+typedef struct s_sprite_ref
+{
+	double		depth;
+	int			index;
+}				t_sprite_ref;
+
+/**
+ * Billboards drawn after the walls. grid buckets them by map cell so each
+ * frame only the sprites inside the view cone are gathered into visible
+ * and sorted far to near.
+ */
+typedef struct s_sprites
+{
+	t_sprite		*items;
+	t_spatial_grid	grid;
+	int				*candidates;
+	t_sprite_ref	*visible;
+	int				count;
+	int				capacity;
+	t_texture	textures[SPRITE_TEXTURES];
+	double		zmax[NUM_RAYS / ZBUFFER_TILE + 1];
+	int			drawn;
+}				t_sprites;
+
 typedef struct s_ray
 {
 	double		x;
@@ -192,6 +362,141 @@ typedef struct s_ray
 	int			hit;
 }				t_ray;
 
+/* Wall face seen by a ray, also the index into params->wall_textures */
+typedef enum e_face
+{
+	FACE_NORTH,
+	FACE_SOUTH,
+	FACE_EAST,
+	FACE_WEST,
+	FACE_DOOR
+}				t_face;
+
+typedef struct s_ray_hit
+{
+	double		distance;
+	t_fpoint	hit_point;
+	bool		is_vertical;
+	int			map_x;
+	int			map_y;
+	double		ray_angle;
+	t_face		face;
+	int			height; // Wall rows as drawn, set by render_3d_view
+}				t_ray_hit;
+
+/* One wall column as a span hands it to the column drawers: the
+ * perspective-correct texture u and distance, the projected height and
+ * the 16.16 texture step for that height, all derived from the span's
+ * interpolants. */
+typedef struct s_wall_slice
+{
+	t_face			face;
+	double			u;
+	double			distance;
+	int				height;
+	unsigned int	tex_step;
+	unsigned int	light;
+}				t_wall_slice;
+
+typedef struct s_span_stats
+{
+	unsigned long	frames;
+	unsigned long	columns;
+	unsigned long	spans;
+	unsigned long	coalesced;
+}				t_span_stats;
+
+/**
+ * Ownership of a framebuffer in the present ring. A buffer only moves
+ * FREE -> RENDERING -> READY on the render thread and READY -> PRESENTING
+ * -> FREE on the main thread, always under present.swap_lock.
+ */
+typedef enum e_buffer_state
+{
+	BUF_FREE = 0,
+	BUF_RENDERING,
+	BUF_READY,
+	BUF_PRESENTING
+}				t_buffer_state;
+
+typedef struct s_frame_buffer
+{
+	t_img			img;
+	t_buffer_state	state;
+	unsigned long	seq;
+	long			render_start_us;
+	long			render_end_us;
+}				t_frame_buffer;
+
+typedef struct s_present_stats
+{
+	unsigned long	frames_rendered;
+	unsigned long	frames_presented;
+	unsigned long	present_starved;
+	unsigned long	frames_dropped;
+	long			render_us_total;
+	long			render_wait_us_total;
+	long			sync_us_total;
+	long			latency_us_total;
+	long			latency_us_max;
+	long			started_us;
+}				t_present_stats;
+
+/**
+ * Render/present pipeline state. world_lock serialises access to the
+ * world between the main thread and the render thread, which holds it
+ * only to copy the world into view. frame_lock is held by the render
+ * thread while it draws, so reports can read its state; swap_lock and
+ * swap_cond guard the buffer ring and the pacing estimates: last_tick_us,
+ * the last present_frame call, and the running mean and mean deviation of
+ * the render time.
+ */
+typedef struct s_present
+{
+	pthread_t		thread;
+	pthread_mutex_t	world_lock;
+	pthread_mutex_t	frame_lock;
+	struct s_params	*view;
+	pthread_mutex_t	swap_lock;
+	pthread_cond_t	swap_cond;
+	t_frame_buffer	buffers[PRESENT_BUFFERS];
+	int				presenting;
+	unsigned long	next_seq;
+	long			last_tick_us;
+	long			render_est_us;
+	long			render_dev_us;
+	bool			running;
+	bool			started;
+	t_present_stats	stats;
+}				t_present;
+
+/**
+ * Player-centred minimap. lod[k] is the occupancy pyramid: one byte of
+ * wall density (0-255) per 2^k x 2^k block of cells. The background is
+ * cached in a packed 32bpp layer slightly larger than the viewport and
+ * only repainted when the view scrolls past its margin, the zoom changes
+ * or a cell inside the dirty rectangle (inclusive, in map cells) changes.
+ * Coordinates named "global px" are minimap pixels at the current zoom
+ * with the map origin at (0, 0).
+ */
+typedef struct s_minimap
+{
+	unsigned char	*lod[MINIMAP_LOD_LEVELS];
+	t_point			lod_dim[MINIMAP_LOD_LEVELS];
+	int				levels;
+	int				zoom;
+	double			scale;
+	t_point			view_origin;
+	unsigned int	*layer;
+	int				layer_side;
+	int				layer_zoom;
+	bool			layer_valid;
+	t_point			layer_origin;
+	bool			dirty;
+	t_point			dirty_min;
+	t_point			dirty_max;
+}				t_minimap;
+
 typedef struct s_wall
 {
 	double		wall_height;
@@ -202,6 +507,236 @@ typedef struct s_wall
 	int			wall_y;
 }				t_wall;
 
+/**
+ * Sliding door in cell (x, y). open goes from 0 (closed) to 1 (slid into
+ * the wall) at speed per second; vertical doors lie along the y axis.
+ */
+typedef struct s_door
+{
+	int			x;
+	int			y;
+	bool		vertical;
+	double		open;
+	double		speed;
+}				t_door;
+
+typedef struct s_doors
+{
+	t_door		*items;
+	int			count;
+	int			capacity;
+	int			*cell_door;
+	long		last_update_us;
+}				t_doors;
+
+typedef struct s_light
+{
+	int			x;
+	int			y;
+	int			intensity;
+	int			radius;
+}				t_light;
+
+/**
+ * Baked light level per map cell. lut maps a level to the brightness
+ * factor (out of 256) used when shading walls and sprites; queue and
+ * visit are scratch space for the flood, visit holding a generation
+ * stamp so it never needs clearing.
+ */
+typedef struct s_lighting
+{
+	unsigned char	*cells;
+	t_light			*lights;
+	int				count;
+	int				capacity;
+	int				*queue;
+	int				*visit;
+	int				generation;
+	unsigned int	lut[LIGHT_FULL + 1];
+	bool			enabled;
+}				t_lighting;
+
+/**
+ * Per-frame tables of the fused post-processing sweep. top/bottom bound
+ * each column's wall span (bottom exclusive); keep values and vignette
+ * factors are out of 256.
+ */
+typedef struct s_post
+{
+	unsigned int	flags;
+	unsigned int	built_flags;
+	double			built_plane;
+	int				top[NUM_RAYS];
+	int				bottom[NUM_RAYS];
+	int				col_keep[NUM_RAYS];
+	int				row_keep[WINDOW_HEIGHT];
+	int				vig_x[WINDOW_WIDTH];
+	int				vig_y[WINDOW_HEIGHT];
+	unsigned char	gamma[256];
+}				t_post;
+
+typedef struct s_interlace_stats
+{
+	unsigned long	frames;
+	unsigned long	full_frames;
+	unsigned long	cast_columns;
+}				t_interlace_stats;
+
+/**
+ * Interlaced rendering state. history holds the previous frame's 3D view
+ * before sprites and post-processing; prev_hits and prev_mask are its ray
+ * hits and the columns that were freshly rendered into it. cols,
+ * row_first, row_pos and row_step are scratch space for the
+ * reconstruction.
+ */
+typedef struct s_interlace
+{
+	bool				enabled;
+	bool				valid;
+	int					parity;
+	double				prev_dir;
+	double				prev_x;
+	double				prev_y;
+	unsigned int		*history;
+	t_ray_hit			prev_hits[NUM_RAYS];
+	unsigned char		mask[NUM_RAYS];
+	unsigned char		prev_mask[NUM_RAYS];
+	int					cols[NUM_RAYS];
+	int					row_first[NUM_RAYS];
+	long				row_pos[NUM_RAYS];
+	long				row_step[NUM_RAYS];
+	t_interlace_stats	stats;
+}				t_interlace;
+
+/**
+ * Palette-indexed 3D view. pixels is WINDOW_WIDTH bytes per row; walls
+ * and sky are the wall textures and sky quantized to palette, in the same
+ * layouts. inverse maps an RGB555 colour to its nearest palette entry and
+ * remap[level][i] is entry i shaded to level / (PALETTE_LEVELS - 1).
+ */
+typedef struct s_indexed
+{
+	bool			enabled;
+	int				colors;
+	unsigned char	*pixels;
+	unsigned char	*inverse;
+	unsigned char	*walls[WALL_TEXTURES];
+	unsigned char	*sky;
+	unsigned int	palette[PALETTE_COLORS];
+	unsigned char	remap[PALETTE_LEVELS][PALETTE_COLORS];
+}				t_indexed;
+
+/* Held keys, as tracked by the KeyPress/KeyRelease hooks */
+typedef enum e_input
+{
+	INPUT_FORWARD = 1,
+	INPUT_BACK = 2,
+	INPUT_STRAFE_LEFT = 4,
+	INPUT_STRAFE_RIGHT = 8,
+	INPUT_TURN_LEFT = 16,
+	INPUT_TURN_RIGHT = 32
+}				t_input;
+
+typedef struct s_sim_stats
+{
+	unsigned long	ticks;
+	unsigned long	updates;
+	unsigned long	dropped_ticks;
+	int				max_ticks;
+}				t_sim_stats;
+
+/**
+ * Fixed-step simulation clock. time_us is simulated time, advanced by
+ * SIM_TICK_US per tick; tick_wall_us is the wall-clock time the latest
+ * tick stands for. prev is the player before that tick, for interpolation.
+ * clock_skew_us is how far the clock sim_update runs on is from
+ * get_time_us: 0 live, the virtual clock's lead in a fast replay.
+ */
+typedef struct s_sim
+{
+	unsigned int	held;
+	long			last_wall_us;
+	long			tick_wall_us;
+	long			acc_us;
+	long			time_us;
+	long			clock_skew_us;
+	t_player		prev;
+	t_sim_stats		stats;
+}				t_sim;
+
+typedef enum e_replay_mode
+{
+	REPLAY_OFF,
+	REPLAY_RECORD,
+	REPLAY_PLAY
+}				t_replay_mode;
+
+/* A key press or release, applied before simulation tick `tick` */
+typedef struct s_replay_event
+{
+	unsigned int	tick;
+	int				keycode;
+	bool			down;
+}				t_replay_event;
+
+/* The player after a tick, stored to detect a diverging replay */
+typedef struct s_replay_pose
+{
+	float			x;
+	float			y;
+	float			direction;
+}				t_replay_pose;
+
+/**
+ * Input recorder and player (src/game/replay.c). tick counts the ticks
+ * recorded or played so far; a loaded replay holds tick_count poses and
+ * event_count events, next_event being the first not yet applied.
+ */
+typedef struct s_replay
+{
+	t_replay_mode	mode;
+	bool			fast;
+	const char		*path;
+	FILE			*file;
+	unsigned int	tick;
+	unsigned int	tick_count;
+	t_replay_event	*events;
+	int				event_count;
+	int				event_capacity;
+	int				next_event;
+	t_replay_pose	*poses;
+	unsigned int	pose_capacity;
+	unsigned long	diverged;
+	unsigned int	first_divergence;
+	long			clock_us;
+}				t_replay;
+
+typedef struct s_pacer_stats
+{
+	unsigned long	frames;
+	unsigned long	missed;
+	long			late_ns_total;
+	long			late_ns_max;
+}				t_pacer_stats;
+
+typedef struct s_pacer
+{
+	long			period_ns;
+	long			spin_ns;
+	long			deadline_ns;
+	t_pacer_stats	stats;
+}				t_pacer;
+
+/* Command line, see parse_args in main.c */
+typedef struct s_options
+{
+	bool			headless;
+	int				headless_frames;
+	const char		*record_path;
+	const char		*replay_path;
+	bool			replay_fast;
+}				t_options;
+
 typedef struct s_params
 {
 	void		*mlx;
@@ -224,12 +759,37 @@ typedef struct s_params
 	double  dist_proj_plane; // Distance to projection plane for 3D rendering
 	t_wall		wall;
 
+	t_present	present;
+	t_minimap	minimap;
+	t_sprites	sprites;
+	t_doors		doors;
+	t_lighting	lighting;
+	t_post		post;
+	t_interlace	interlace;
+	t_texture	wall_textures[WALL_TEXTURES];
+	t_texture16	wall_textures16[WALL_TEXTURES];
+	t_rgb565_lut	rgb565;
+	bool		textures_565;
+	t_texture	sky;
+	bool		sky_enabled;
+	t_indexed	indexed;
+	t_span_stats	span_stats;
+	double		column_tan[NUM_RAYS]; // tan of each ray's angle off the view axis
+	t_sim		sim;
+	t_replay	replay;
+	t_pacer		pacer;
 }				t_params;
 
+
 int				put_pixel(t_params *params, int x, int y, int color);
 void			bresenham_algorithm(t_point p1, t_point p2, t_point *delta,
 					t_point *sign);
+bool			clip_line(t_point *p1, t_point *p2, int w, int h);
 void			draw_line(t_params *params, t_point p1, t_point p2, int color);
+void			draw_segments(t_params *params, const t_point *ends, int count,
+					int color);
+int				window_draw_segments(void *mlx_ptr, void *win_ptr,
+					const int *coords, int count, int color);
 void			draw_line_img(t_params *params, t_point p1, t_point p2,
 					int color);
 
@@ -240,4 +800,162 @@ t_fpoint		find_horizontal_wall_intersection(t_params *params,
 double			calculate_euclidean_distance(double x1, double y1, double x2,
 					double y2);
 
+/* Rendering (src/graphics/render.c) */
+void			render_frame(t_params *params, t_ray_hit *ray_hits);
+void			clear_image_direct(t_params *params, int color);
+void			cast_rays(t_params *params, t_ray_hit *ray_hits);
+void			cast_rays_masked(t_params *params, t_ray_hit *ray_hits,
+					const unsigned char *mask);
+void			render_3d_view(t_params *params, t_ray_hit *ray_hits);
+void			render_3d_view_masked(t_params *params, t_ray_hit *ray_hits,
+					const unsigned char *mask);
+void			draw_vertical_slice_direct(t_params *params, int x,
+					int y_start, int y_end, int color, double distance);
+int				apply_shading(int color, double distance);
+double			normalize_angle(double angle);
+int				render_init(t_params *params);
+void			render_free(t_params *params);
+void			render_report_spans(t_params *params, FILE *out);
+
+/* Minimap (src/graphics/minimap.c) */
+int				minimap_init(t_params *params);
+void			minimap_invalidate_cell(t_params *params, int x, int y);
+void			minimap_zoom(t_params *params, int delta);
+t_point			minimap_world_to_px(t_params *params, double x, double y);
+void			minimap_free(t_params *params);
+void			draw_map(t_params *params);
+void			draw_player(t_params *params);
+void			draw_rays_minimap(t_params *params, t_ray_hit *ray_hits);
+
+/* Textures (src/graphics/textures.c) */
+int				texture_alloc(t_texture *tex, int width, int height);
+void			texture_free(t_texture *tex);
+int				texture_generate_sprite(t_texture *tex, int kind);
+int				texture_generate_wall(t_texture *tex, int kind);
+int				texture_generate_sky(t_texture *tex, int width, int height);
+int				texture_pack_565(t_texture16 *dst, const t_texture *src);
+void			texture16_free(t_texture16 *tex);
+void			rgb565_lut_init(t_rgb565_lut *lut);
+
+/* Sprites (src/graphics/sprites.c) */
+int				sprites_init(t_params *params);
+int				sprite_add(t_params *params, double x, double y, int texture);
+void			sprites_free(t_params *params);
+void			render_sprites(t_params *params, t_ray_hit *ray_hits);
+unsigned int	shade_color(unsigned int color, unsigned int brightness);
+
+/* Dynamic cells (src/utils/map_cells.c) */
+int				cells_init(t_params *params);
+void			cells_free(t_params *params);
+unsigned char	cell_occupancy(t_params *params, int x, int y);
+bool			cell_is_solid(t_params *params, int x, int y);
+int				cell_set(t_params *params, int x, int y, char value);
+int				cell_move_wall(t_params *params, t_point from, t_point to);
+t_door			*door_at(t_params *params, int x, int y);
+bool			door_toggle(t_params *params, int x, int y);
+void			doors_update(t_params *params, long now_us);
+bool			door_blocks_ray(t_params *params, int x, int y, bool vertical,
+					t_fpoint mid);
+
+/* Lightmap (src/graphics/lighting.c) */
+int				lighting_init(t_params *params);
+void			lighting_free(t_params *params);
+int				light_add(t_params *params, int x, int y, int intensity,
+					int radius);
+void			light_remove(t_params *params, int index);
+void			lighting_relight_cell(t_params *params, int x, int y);
+unsigned char	lighting_sample_hit(t_params *params, const t_ray_hit *hit);
+unsigned char	lighting_sample(t_params *params, double x, double y);
+
+/* Post-processing (src/graphics/postprocess.c) */
+int				post_fog_keep(double depth);
+void			post_process(t_params *params, t_ray_hit *ray_hits);
+void			post_report_costs(t_params *params, FILE *out);
+
+/* Palette-indexed rendering (src/graphics/indexed.c) */
+int				indexed_init(t_params *params);
+void			indexed_free(t_params *params);
+void			indexed_draw_fill(t_params *params, int x, int y0, int y1,
+					int base_color, double distance);
+void			indexed_draw_wall_column(t_params *params, int x,
+					const t_wall_slice *s);
+void			indexed_draw_sky(t_params *params, int first);
+void			indexed_expand(t_params *params);
+
+/* Interlaced rendering (src/graphics/interlace.c) */
+void			interlace_render(t_params *params, t_ray_hit *ray_hits);
+void			interlace_invalidate(t_params *params);
+void			interlace_free(t_params *params);
+
+/* Triangle fan filler (src/graphics/fan_fill.c) */
+void			fill_triangle_fan(t_img *img, const t_fan *fan);
+
+/* Render/present threads (src/graphics/present.c) */
+int				present_init(t_params *params);
+int				present_start(t_params *params);
+void			present_frame(t_params *params);
+void			present_shutdown(t_params *params);
+void			world_lock(t_params *params);
+void			world_unlock(t_params *params);
+void			render_pause(t_params *params);
+void			render_resume(t_params *params);
+
+/* Render thread's copy of the world (src/graphics/render_view.c) */
+t_params		*view_new(t_params *params);
+int				view_sync(t_params *view, t_params *params, long now_us);
+void			view_free(t_params *view, t_params *params);
+
+/* Fixed-step simulation (src/game/simulation.c) */
+int				is_wall_at(t_params *params, double x, double y);
+void			sim_set_key(t_params *params, unsigned int input, bool down);
+void			sim_tick(t_params *params);
+void			sim_update(t_params *params, long now_us);
+long			sim_clock(t_params *params);
+t_player		sim_pose_at(t_params *params, long now_us);
+void			render_interpolated(t_params *params, t_ray_hit *ray_hits,
+					long now_us);
+void			sim_report(t_params *params);
+
+/* World setup (src/game/world.c) */
+int				world_load(t_params *params, const char *const *layout,
+					int rows);
+void			world_free(t_params *params);
+
+/* Keyboard input (src/game/input.c) */
+void			input_key(t_params *params, int keycode, bool down);
+
+/* Input recording and replay (src/game/replay.c) */
+int				replay_record_open(t_params *params, const char *path);
+int				replay_load(t_params *params, const char *path, bool fast);
+void			replay_record_key(t_params *params, int keycode, bool down);
+void			replay_before_tick(t_params *params);
+void			replay_after_tick(t_params *params);
+bool			replay_done(t_params *params);
+long			replay_clock(t_params *params);
+void			replay_close(t_params *params);
+
+/* Headless benchmark (src/game/headless.c) */
+int				headless_run(t_params *params, int frames, FILE *out);
+
+/* Frame pacer (src/utils/frame_pacer.c) */
+void			pacer_init(t_pacer *pacer, int hz, long spin_ns);
+void			pacer_wait(t_pacer *pacer);
+void			pacer_report(t_pacer *pacer);
+
+/* Time helpers (src/utils/time_utils.c) */
+long			get_time_ns(void);
+long			get_time_ms(void);
+long			get_time_us(void);
+
+static inline void	put_pixel_direct(t_img *img, int x, int y, int color)
+{
+	char	*dst;
+
+	if (x >= 0 && x < img->width && y >= 0 && y < img->height)
+	{
+		dst = img->addr + (y * img->line_length + x * (img->bpp));
+		*(unsigned int *)dst = color;
+	}
+}
+
 #endif // CUB3D_H
@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+# define PROFILER_H
+
+# include <stdbool.h>
+# include <stdio.h>
+
+/*
+ * Per-stage frame profiler, built only with -D PROFILE (make profile).
+ * PROF_BEGIN/PROF_END bracket a stage within one block; each thread
+ * appends durations to its own ring of the last PROF_RING_SIZE samples per
+ * stage, so recording takes no lock. Without PROFILE every macro is a
+ * no-op.
+ *
+ * The same scopes feed the trace export: once armed by --trace or
+ * SIGUSR1, every stage ended during a window of frames is also stored in a
+ * preallocated event buffer and written as Chrome trace-event JSON, which
+ * Perfetto and chrome://tracing open directly.
+ *
+ * With --perf, each thread also opens a group of perf_event counters
+ * (cycles, instructions, cache and branch misses; software events where
+ * the hardware ones are refused) and every stage adds its deltas to the
+ * thread's ring, so the report shows IPC and misses per stage. Without
+ * the permission or the PMU, profiling carries on with timing only.
+ */
+typedef enum e_prof_stage
+{
+	PROF_SIM,
+	PROF_CLEAR,
+	PROF_CAST,
+	PROF_WALLS,
+	PROF_SPRITES,
+	PROF_POST,
+	PROF_MINIMAP,
+	PROF_PRESENT,
+	PROF_SLEEP,
+	PROF_STAGES
+}				t_prof_stage;
+
+# define PROF_RING_SIZE 1024
+# define PROF_MAX_THREADS 4
+# define TRACE_MAX_EVENTS 65536
+# define TRACE_DEFAULT_FRAMES 120
+# define TRACE_DEFAULT_PATH "cub3d_trace.json"
+# define PERF_MAX_EVENTS 4
+
+# ifdef PROFILE
+
+/* One read of the calling thread's counter group */
+typedef struct s_perf_sample
+{
+	unsigned long long	value[PERF_MAX_EVENTS];
+	unsigned long long	enabled;
+	unsigned long long	running;
+}				t_perf_sample;
+
+/* Where a stage began, see PROF_BEGIN */
+typedef struct s_prof_mark
+{
+	long			ns;
+	bool			perf_ok;
+	t_perf_sample	perf;
+}				t_prof_mark;
+
+typedef struct s_prof_ring
+{
+	unsigned int		samples[PROF_STAGES][PROF_RING_SIZE];
+	unsigned long		count[PROF_STAGES];
+	unsigned long long	perf[PROF_STAGES][PERF_MAX_EVENTS];
+	unsigned long		perf_count[PROF_STAGES];
+}				t_prof_ring;
+
+typedef struct s_prof_stats
+{
+	int				samples;
+	double			mean_us;
+	double			p50_us;
+	double			p95_us;
+	double			p99_us;
+}				t_prof_stats;
+
+typedef enum e_trace_state
+{
+	TRACE_IDLE,
+	TRACE_ARMED,
+	TRACE_ACTIVE,
+	TRACE_DONE
+}				t_trace_state;
+
+typedef struct s_trace_event
+{
+	long			start_ns;
+	unsigned int	dur_ns;
+	unsigned int	frame;
+	unsigned char	stage;
+	unsigned char	tid;
+}				t_trace_event;
+
+typedef struct s_trace
+{
+	t_trace_event	*events;
+	unsigned long	count;
+	const char		*path;
+	int				state;
+	unsigned int	frame;
+	unsigned int	first;
+	unsigned int	last;
+}				t_trace;
+
+long			get_time_ns(void);
+t_prof_mark		prof_begin(void);
+void			prof_end(t_prof_stage stage, const t_prof_mark *mark);
+void			prof_record(t_prof_stage stage, long start_ns, long end_ns);
+void			prof_report(FILE *out);
+int				prof_stage_stats(t_prof_stage stage, t_prof_stats *stats);
+int				prof_stage_perf(t_prof_stage stage, double *mean);
+const char		*prof_stage_name(t_prof_stage stage);
+void			prof_reset(void);
+void			prof_thread(const char *name);
+void			prof_frame(void);
+int				prof_trace_init(const char *path, int first, int count);
+void			prof_trace_flush(bool force);
+int				prof_perf_init(void);
+int				prof_perf_read(t_perf_sample *sample);
+int				prof_perf_events(void);
+const char		*prof_perf_name(int event);
+bool			prof_perf_hardware(void);
+
+#  define PROF_BEGIN(stage) t_prof_mark prof_m_##stage = prof_begin()
+#  define PROF_END(stage) prof_end(stage, &prof_m_##stage)
+#  define PROF_REPORT(out) prof_report(out)
+#  define PROF_RESET() prof_reset()
+#  define PROF_THREAD(name) prof_thread(name)
+#  define PROF_FRAME() prof_frame()
+#  define PROF_TRACE_FLUSH(force) prof_trace_flush(force)
+
+# else
+
+#  define PROF_BEGIN(stage) ((void)0)
+#  define PROF_END(stage) ((void)0)
+#  define PROF_REPORT(out) ((void)0)
+#  define PROF_RESET() ((void)0)
+#  define PROF_THREAD(name) ((void)0)
+#  define PROF_FRAME() ((void)0)
+#  define PROF_TRACE_FLUSH(force) ((void)0)
+
+# endif
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SPATIAL_GRID_H
+# define SPATIAL_GRID_H
+
+# include <stdbool.h>
+
+/*
+ * Uniform grid of entity buckets aligned with the map cells. Every bucket
+ * is an intrusive doubly linked list threaded through the entry table, so
+ * insert, move and remove are O(1) and queries only visit the cells they
+ * overlap. Entities are identified by caller-owned integer ids.
+ *
+ * The game only inserts its static sprites and culls them with the cone
+ * query; nothing in it moves, so move, remove and the radius query are
+ * exercised by bench/bench_spatial_grid.c alone.
+ */
+typedef struct s_grid_entry
+{
+	double				x;
+	double				y;
+	int					cell;
+	int					prev;
+	int					next;
+}						t_grid_entry;
+
+typedef struct s_spatial_grid
+{
+	int					cols;
+	int					rows;
+	double				cell_size;
+	int					*heads;
+	t_grid_entry		*entries;
+	int					capacity;
+	int					count;
+}						t_spatial_grid;
+
+/*
+ * View cone from (x, y) looking along dir, accepting entities within
+ * margin of its edges (margin is usually the entity radius).
+ */
+typedef struct s_grid_frustum
+{
+	double				x;
+	double				y;
+	double				dir;
+	double				half_fov;
+	double				far;
+	double				margin;
+}						t_grid_frustum;
+
+int						grid_init(t_spatial_grid *grid, int cols, int rows,
+							double cell_size);
+void					grid_free(t_spatial_grid *grid);
+int						grid_insert(t_spatial_grid *grid, int id, double x,
+							double y);
+void					grid_move(t_spatial_grid *grid, int id, double x,
+							double y);
+void					grid_remove(t_spatial_grid *grid, int id);
+bool					grid_contains(t_spatial_grid *grid, int id);
+int						grid_query_radius(t_spatial_grid *grid, double x,
+							double y, double radius, int *out, int max_out);
+int						grid_query_frustum(t_spatial_grid *grid,
+							const t_grid_frustum *frustum, int *out,
+							int max_out);
+
+#endif
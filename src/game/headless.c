@@ -0,0 +1,182 @@
+#include "../../include/cub3d.h"
+
+// --- Headless Benchmark ---
+//
+// Runs the game without an X connection: frames are rendered into a plain
+// aligned buffer laid out like an MLX image, while a scripted camera path
+// holds keys for the simulation on a virtual FRAME_RATE_CAP clock. Every
+// run therefore renders the same frames, however fast the machine is, and
+// the timings are comparable between runs and between changes.
+
+typedef struct s_camera_step {
+  int frames;
+  unsigned int held; // t_input bits
+} t_camera_step;
+
+static const t_camera_step g_camera_path[] = {
+    {60, 0},
+    {120, INPUT_TURN_LEFT},
+    {90, INPUT_FORWARD},
+    {60, INPUT_FORWARD | INPUT_TURN_RIGHT},
+    {60, INPUT_STRAFE_LEFT},
+    {90, INPUT_BACK | INPUT_TURN_LEFT},
+    {60, INPUT_TURN_RIGHT},
+};
+
+// Keys held during frame i of the path, which repeats once it runs out.
+static unsigned int camera_input(int i) {
+  const int steps = sizeof(g_camera_path) / sizeof(g_camera_path[0]);
+  int total = 0, s;
+
+  for (s = 0; s < steps; s++)
+    total += g_camera_path[s].frames;
+  i %= total;
+  for (s = 0; i >= g_camera_path[s].frames; s++)
+    i -= g_camera_path[s].frames;
+  return g_camera_path[s].held;
+}
+
+static int headless_image(t_img *img) {
+  ft_memset(img, 0, sizeof(*img));
+  img->width = WINDOW_WIDTH;
+  img->height = WINDOW_HEIGHT;
+  img->bpp = 4;
+  img->bits_per_pixel = 32;
+  img->line_length =
+      (WINDOW_WIDTH * 4 + HEADLESS_ALIGN - 1) / HEADLESS_ALIGN * HEADLESS_ALIGN;
+  img->addr = aligned_alloc(HEADLESS_ALIGN,
+                            (size_t)img->line_length * WINDOW_HEIGHT);
+  return img->addr ? 0 : -1;
+}
+
+static int compare_times(const void *a, const void *b) {
+  long x = *(const long *)a, y = *(const long *)b;
+
+  return (x > y) - (x < y);
+}
+
+#ifdef PROFILE
+// Mean counter deltas per stage run, when --perf opened any.
+static void write_stages_perf(FILE *out) {
+  double mean[PERF_MAX_EVENTS];
+  const char *sep = "";
+  int s, i, runs;
+
+  if (prof_perf_events() == 0)
+    return;
+  fprintf(out, ",\n  \"stages_perf\": {");
+  for (s = 0; s < PROF_STAGES; s++) {
+    runs = prof_stage_perf(s, mean);
+    if (runs == 0)
+      continue;
+    fprintf(out, "%s\n    \"%s\": {\"runs\": %d", sep, prof_stage_name(s),
+            runs);
+    for (i = 0; i < prof_perf_events(); i++)
+      fprintf(out, ", \"%s\": %.0f", prof_perf_name(i), mean[i]);
+    if (prof_perf_hardware())
+      fprintf(out, ", \"ipc\": %.3f", mean[0] > 0 ? mean[1] / mean[0] : 0.0);
+    fputc('}', out);
+    sep = ",";
+  }
+  fprintf(out, "\n  }");
+}
+#endif
+
+static void write_stages(FILE *out) {
+#ifdef PROFILE
+  t_prof_stats st;
+  const char *sep = "";
+  int s;
+
+  fprintf(out, ",\n  \"stages_us\": {");
+  for (s = 0; s < PROF_STAGES; s++) {
+    if (prof_stage_stats(s, &st) == 0)
+      continue;
+    fprintf(out,
+            "%s\n    \"%s\": {\"samples\": %d, \"mean\": %.2f, \"p50\": %.2f, "
+            "\"p95\": %.2f, \"p99\": %.2f}",
+            sep, prof_stage_name(s), st.samples, st.mean_us, st.p50_us,
+            st.p95_us, st.p99_us);
+    sep = ",";
+  }
+  fprintf(out, "\n  }");
+  write_stages_perf(out);
+#else
+  (void)out;
+#endif
+}
+
+static void write_report(FILE *out, long *frame_ns, int frames, long total_ns) {
+  double sum = 0.0;
+  int i;
+
+  if (frames == 0) {
+    fprintf(out, "{\n  \"frames\": 0\n}\n");
+    return;
+  }
+  qsort(frame_ns, frames, sizeof(*frame_ns), compare_times);
+  for (i = 0; i < frames; i++)
+    sum += frame_ns[i];
+  fprintf(out,
+          "{\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n"
+          "  \"warmup_frames\": %d,\n  \"seconds\": %.4f,\n  \"fps\": %.2f,\n"
+          "  \"frame_ms\": {\"mean\": %.3f, \"p50\": %.3f, \"p95\": %.3f, "
+          "\"p99\": %.3f, \"max\": %.3f}",
+          WINDOW_WIDTH, WINDOW_HEIGHT, frames, HEADLESS_WARMUP_FRAMES,
+          total_ns / 1e9, frames / (total_ns / 1e9), sum / frames / 1e6,
+          frame_ns[frames / 2] / 1e6, frame_ns[frames * 95 / 100] / 1e6,
+          frame_ns[frames * 99 / 100] / 1e6, frame_ns[frames - 1] / 1e6);
+  write_stages(out);
+  fprintf(out, "\n}\n");
+}
+
+/**
+ * Renders HEADLESS_WARMUP_FRAMES and then frames timed frames along the
+ * camera path, and writes fps, frame-time percentiles and, in profile
+ * builds, per-stage costs to out as JSON. A loaded replay replaces the
+ * path and runs to its end, paced to FRAME_RATE_CAP unless it is fast;
+ * its warm-up frames show the starting pose. Replaces the window image
+ * with its own buffer; params must not have an MLX connection.
+ *
+ * @return 0 on success, -1 if a buffer cannot be allocated
+ */
+int headless_run(t_params *params, int frames, FILE *out) {
+  static t_ray_hit ray_hits[NUM_RAYS];
+  bool replay = params->replay.mode == REPLAY_PLAY;
+  long *frame_ns, now_us = SIM_TICK_US, start_ns = 0, t0;
+  int i;
+
+  if (replay) // One frame per 1 / FRAME_RATE_CAP of the recording
+    frames = (int)((params->replay.tick_count - params->replay.tick) *
+                   (long)FRAME_RATE_CAP / SIM_HZ) + 2;
+  frame_ns = malloc(sizeof(*frame_ns) * (frames > 0 ? frames : 1));
+  if (!frame_ns || frames <= 0 || headless_image(&params->window_img) != 0) {
+    free(frame_ns);
+    return -1;
+  }
+  for (i = -HEADLESS_WARMUP_FRAMES; i < frames; i++) {
+    if (i == 0) {
+      PROF_RESET();
+      start_ns = get_time_ns();
+    }
+    if (i >= 0 && replay_done(params))
+      break;
+    t0 = get_time_ns();
+    if (!replay)
+      params->sim.held = camera_input(i + HEADLESS_WARMUP_FRAMES);
+    if (!replay || i >= 0)
+      sim_update(params, now_us);
+    render_interpolated(params, ray_hits, now_us);
+    if (i >= 0)
+      frame_ns[i] = get_time_ns() - t0;
+    if (!replay || i >= 0)
+      now_us += 1000000L / FRAME_RATE_CAP;
+    if (replay && !params->replay.fast)
+      pacer_wait(&params->pacer);
+  }
+  write_report(out, frame_ns, i, get_time_ns() - start_ns);
+  free(frame_ns);
+  free(params->window_img.addr);
+  params->window_img.addr = NULL;
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include "../../include/cub3d.h"
+#include <X11/keysym.h>
+
+// --- Keyboard Input ---
+//
+// Key handling shared by the X hooks and by replays, which feed the
+// recorded keys back through here. Escape is left to the hooks.
+
+// Movement keys and the player input they hold down.
+static unsigned int key_input(int keycode) {
+  if (keycode == XK_w || keycode == XK_Up)
+    return INPUT_FORWARD;
+  if (keycode == XK_s || keycode == XK_Down)
+    return INPUT_BACK;
+  if (keycode == XK_a)
+    return INPUT_STRAFE_LEFT;
+  if (keycode == XK_d)
+    return INPUT_STRAFE_RIGHT;
+  if (keycode == XK_Left)
+    return INPUT_TURN_LEFT;
+  if (keycode == XK_Right)
+    return INPUT_TURN_RIGHT;
+  return 0;
+}
+
+// Flips a rendering option; the interlace history no longer matches.
+static void toggle(t_params *params, bool *option) {
+  *option = !*option;
+  interlace_invalidate(params);
+}
+
+/**
+ * Applies a key press or release. Call with world_lock held.
+ */
+void input_key(t_params *params, int keycode, bool down) {
+  if (!down || key_input(keycode)) {
+    // Movement only records the held key; sim_tick applies it
+    sim_set_key(params, key_input(keycode), down);
+    return;
+  }
+  if (keycode == XK_minus || keycode == XK_equal)
+    minimap_zoom(params, (keycode == XK_minus) ? 1 : -1);
+  else if (keycode == XK_l)
+    toggle(params, &params->lighting.enabled);
+  else if (keycode == XK_k)
+    toggle(params, &params->sky_enabled);
+  else if (keycode == XK_6) // Sample walls from their RGB565 copies
+    toggle(params, &params->textures_565);
+  else if (keycode == XK_8) // 8-bit palette-indexed 3D view
+    toggle(params, &params->indexed.enabled);
+  else if (keycode == XK_i)
+    toggle(params, &params->interlace.enabled);
+  else if (keycode == XK_f || keycode == XK_v || keycode == XK_g)
+    params->post.flags ^= (keycode == XK_f)   ? POST_FOG
+                          : (keycode == XK_v) ? POST_VIGNETTE
+                                              : POST_GAMMA;
+  else if (keycode == XK_t) { // Spans, plus make profile / counters stats
+    render_pause(params);
+    render_report_spans(params, stderr);
+    PROF_REPORT(stderr);
+    COUNT_REPORT(stderr);
+    render_resume(params);
+  }
+  else if (keycode == XK_p) {
+    render_pause(params);
+    post_report_costs(params, stderr);
+    render_resume(params);
+  }
+  else if (keycode == XK_e) // Use the door in front of the player
+    door_toggle(params,
+                (int)((params->player.x +
+                       cos(params->player.direction) * TILE_SIZE) /
+                      TILE_SIZE),
+                (int)((params->player.y +
+                       sin(params->player.direction) * TILE_SIZE) /
+                      TILE_SIZE));
+}
@@ -0,0 +1,242 @@
+#include "../../include/cub3d.h"
+
+// --- Input Recording and Replay ---
+//
+// The simulation only changes through keys applied between ticks, so a
+// run is reproduced by the keys and the tick each one preceded. The file
+// is a header followed by one record per key and one per tick:
+//
+//   header  "C3RP", u8 version, u8 0, u16 SIM_HZ, u16 rows, u16 cols,
+//           f32 x, y, direction of the starting pose
+//   'K'     i32 keycode, u8 down: applied before the next tick
+//   'T'     f32 x, y, direction: the player after the tick
+//
+// in host byte order. The poses are not needed to replay; they let the
+// player notice when the same keys no longer lead to the same run.
+
+static int put(FILE *f, const void *data, size_t size) {
+  return (fwrite(data, 1, size, f) == size) ? 0 : -1;
+}
+
+static int get(FILE *f, void *data, size_t size) {
+  return (fread(data, 1, size, f) == size) ? 0 : -1;
+}
+
+static t_replay_pose player_pose(t_params *params) {
+  return (t_replay_pose){(float)params->player.x, (float)params->player.y,
+                         (float)params->player.direction};
+}
+
+static bool pose_matches(t_replay_pose a, t_replay_pose b) {
+  return fabsf(a.x - b.x) <= REPLAY_POSE_EPSILON &&
+         fabsf(a.y - b.y) <= REPLAY_POSE_EPSILON &&
+         fabsf(a.direction - b.direction) <= REPLAY_POSE_EPSILON;
+}
+
+static int put_pose(FILE *f, t_replay_pose pose) {
+  return put(f, &pose.x, 4) || put(f, &pose.y, 4) ||
+         put(f, &pose.direction, 4);
+}
+
+static int get_pose(FILE *f, t_replay_pose *pose) {
+  return get(f, &pose->x, 4) || get(f, &pose->y, 4) ||
+         get(f, &pose->direction, 4);
+}
+
+/**
+ * Starts recording to path, overwriting it.
+ *
+ * @return 0 on success, -1 with errno set if the file cannot be written
+ */
+int replay_record_open(t_params *params, const char *path) {
+  t_replay *r = &params->replay;
+  unsigned char version[2] = {REPLAY_VERSION, 0};
+  unsigned short hz = SIM_HZ, rows = params->map.rows,
+                 cols = params->map.cols;
+
+  r->file = fopen(path, "wb");
+  if (!r->file)
+    return -1;
+  if (put(r->file, REPLAY_MAGIC, 4) || put(r->file, version, 2) ||
+      put(r->file, &hz, 2) || put(r->file, &rows, 2) ||
+      put(r->file, &cols, 2) || put_pose(r->file, player_pose(params))) {
+    fclose(r->file);
+    r->file = NULL;
+    return -1;
+  }
+  r->path = path;
+  r->mode = REPLAY_RECORD;
+  return 0;
+}
+
+static int push_event(t_replay *r, t_replay_event event) {
+  t_replay_event *events;
+  int capacity;
+
+  if (r->event_count == r->event_capacity) {
+    capacity = r->event_capacity ? r->event_capacity * 2 : 64;
+    events = realloc(r->events, capacity * sizeof(*events));
+    if (!events)
+      return -1;
+    r->events = events;
+    r->event_capacity = capacity;
+  }
+  r->events[r->event_count++] = event;
+  return 0;
+}
+
+static int push_pose(t_replay *r, t_replay_pose pose) {
+  t_replay_pose *poses;
+  unsigned int capacity;
+
+  if (r->tick_count == r->pose_capacity) {
+    capacity = r->pose_capacity ? r->pose_capacity * 2 : 1024;
+    poses = realloc(r->poses, capacity * sizeof(*poses));
+    if (!poses)
+      return -1;
+    r->poses = poses;
+    r->pose_capacity = capacity;
+  }
+  r->poses[r->tick_count++] = pose;
+  return 0;
+}
+
+// Reads the records after the header; -1 on a truncated or unknown one.
+static int load_records(t_replay *r, FILE *f) {
+  t_replay_event event;
+  t_replay_pose pose;
+  unsigned char down;
+  int tag;
+
+  while ((tag = fgetc(f)) != EOF) {
+    if (tag == 'K') {
+      event.tick = r->tick_count;
+      if (get(f, &event.keycode, 4) || get(f, &down, 1))
+        return -1;
+      event.down = down;
+      if (push_event(r, event) != 0)
+        return -1;
+    } else if (tag != 'T' || get_pose(f, &pose) || push_pose(r, pose) != 0)
+      return -1;
+  }
+  return 0;
+}
+
+/**
+ * Loads a recording to play back from the next tick, in real time or,
+ * with fast, on a virtual clock (see replay_clock). It must have been
+ * recorded at the same tick rate, on a map of the same size, from the
+ * same starting pose.
+ *
+ * @return 0 on success, -1 after printing why the file was refused
+ */
+int replay_load(t_params *params, const char *path, bool fast) {
+  t_replay *r = &params->replay;
+  unsigned char magic[4], version[2];
+  unsigned short hz, rows, cols;
+  t_replay_pose start;
+  FILE *f = fopen(path, "rb");
+  int status = -1;
+
+  if (!f) {
+    perror(path);
+    return -1;
+  }
+  if (get(f, magic, 4) || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+      get(f, version, 2) || version[0] != REPLAY_VERSION || get(f, &hz, 2) ||
+      get(f, &rows, 2) || get(f, &cols, 2) || get_pose(f, &start))
+    fprintf(stderr, "Error: %s is not a cub3D recording\n", path);
+  else if (hz != SIM_HZ || rows != params->map.rows ||
+           cols != params->map.cols ||
+           !pose_matches(start, player_pose(params)))
+    fprintf(stderr, "Error: %s was recorded at %d Hz on another map\n", path,
+            hz);
+  else if (load_records(r, f) != 0)
+    fprintf(stderr, "Error: %s is truncated or corrupt\n", path);
+  else
+    status = 0;
+  fclose(f);
+  if (status != 0)
+    return status;
+  r->path = path;
+  r->fast = fast;
+  r->mode = REPLAY_PLAY;
+  return 0;
+}
+
+// Logs a key handled by the X hooks. Call with world_lock held.
+void replay_record_key(t_params *params, int keycode, bool down) {
+  t_replay *r = &params->replay;
+  unsigned char d = down;
+
+  if (r->mode != REPLAY_RECORD)
+    return;
+  fputc('K', r->file);
+  put(r->file, &keycode, 4);
+  put(r->file, &d, 1);
+  r->event_count++;
+}
+
+// Applies the recorded keys that preceded the coming tick.
+void replay_before_tick(t_params *params) {
+  t_replay *r = &params->replay;
+
+  if (r->mode != REPLAY_PLAY)
+    return;
+  while (r->next_event < r->event_count &&
+         r->events[r->next_event].tick <= r->tick) {
+    input_key(params, r->events[r->next_event].keycode,
+              r->events[r->next_event].down);
+    r->next_event++;
+  }
+}
+
+// Records the pose after a tick, or checks it against the recording.
+void replay_after_tick(t_params *params) {
+  t_replay *r = &params->replay;
+  t_replay_pose pose;
+
+  if (r->mode == REPLAY_RECORD) {
+    fputc('T', r->file);
+    put_pose(r->file, player_pose(params));
+  } else if (r->mode == REPLAY_PLAY && r->tick < r->tick_count) {
+    pose = player_pose(params);
+    if (!pose_matches(pose, r->poses[r->tick]) && r->diverged++ == 0)
+      r->first_divergence = r->tick;
+  } else
+    return;
+  r->tick++;
+}
+
+bool replay_done(t_params *params) {
+  return params->replay.mode == REPLAY_PLAY &&
+         params->replay.tick >= params->replay.tick_count;
+}
+
+// Virtual time for fast replays: one frame at FRAME_RATE_CAP per call.
+long replay_clock(t_params *params) {
+  params->replay.clock_us += 1000000L / FRAME_RATE_CAP;
+  return params->replay.clock_us;
+}
+
+// Finishes the recording or replay and reports on it.
+void replay_close(t_params *params) {
+  t_replay *r = &params->replay;
+
+  if (r->mode == REPLAY_RECORD) {
+    if (fclose(r->file) != 0)
+      perror(r->path);
+    else
+      fprintf(stderr, "record: %u ticks, %d keys to %s\n", r->tick,
+              r->event_count, r->path);
+  } else if (r->mode == REPLAY_PLAY && r->diverged)
+    fprintf(stderr,
+            "replay: %u of %u ticks, DIVERGED at tick %u (%lu ticks off)\n",
+            r->tick, r->tick_count, r->first_divergence, r->diverged);
+  else if (r->mode == REPLAY_PLAY)
+    fprintf(stderr, "replay: %u of %u ticks, %d keys, poses match\n", r->tick,
+            r->tick_count, r->next_event);
+  free(r->events);
+  free(r->poses);
+  ft_memset(r, 0, sizeof(*r));
+}
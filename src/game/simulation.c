@@ -0,0 +1,156 @@
+#include "../../include/cub3d.h"
+
+// --- Fixed-Step Simulation ---
+//
+// The player and doors advance in ticks of SIM_TICK_US driven by the keys
+// currently held, independent of how often X repeats them or how fast
+// frames are drawn. sim_update runs as many ticks as wall-clock time
+// allows, capped at SIM_MAX_TICKS so a stall cannot snowball. Frames are
+// drawn one tick behind, between the previous and latest tick, so motion
+// stays smooth when the render rate does not divide the tick rate.
+
+int is_wall_at(t_params *params, double x, double y) {
+  if (x < 0 || y < 0 || x >= params->map.cols * TILE_SIZE ||
+      y >= params->map.rows * TILE_SIZE)
+    return 1;
+
+  return cell_is_solid(params, (int)(x / TILE_SIZE), (int)(y / TILE_SIZE));
+}
+
+void sim_set_key(t_params *params, unsigned int input, bool down) {
+  if (down)
+    params->sim.held |= input;
+  else
+    params->sim.held &= ~input;
+}
+
+// Moves by (dx, dy), axis by axis, keeping a quarter tile from walls.
+static void move_player(t_params *params, double dx, double dy) {
+  double collision_dist = TILE_SIZE * 0.25;
+  t_player *p = &params->player;
+
+  if (dx != 0.0 &&
+      !is_wall_at(params, p->x + dx + (dx > 0 ? collision_dist : -collision_dist),
+                  p->y))
+    p->x += dx;
+  if (dy != 0.0 &&
+      !is_wall_at(params, p->x,
+                  p->y + dy + (dy > 0 ? collision_dist : -collision_dist)))
+    p->y += dy;
+}
+
+/**
+ * Advances the world by one SIM_TICK_US step: turns and moves the player
+ * according to the held keys, then animates the doors on simulated time.
+ * A replay applies its keys first; a recording logs the resulting pose.
+ */
+void sim_tick(t_params *params) {
+  const double dt = SIM_TICK_US / 1e6;
+  t_player *p = &params->player;
+  double fwd = 0.0, side = 0.0, step = PLAYER_WALK_SPEED * dt;
+  unsigned int held;
+
+  replay_before_tick(params);
+  held = params->sim.held;
+  if (held & INPUT_TURN_LEFT)
+    p->direction -= PLAYER_TURN_SPEED * dt;
+  if (held & INPUT_TURN_RIGHT)
+    p->direction += PLAYER_TURN_SPEED * dt;
+  p->direction = normalize_angle(p->direction);
+  fwd = ((held & INPUT_FORWARD) != 0) - ((held & INPUT_BACK) != 0);
+  side = ((held & INPUT_STRAFE_LEFT) != 0) - ((held & INPUT_STRAFE_RIGHT) != 0);
+  if (fwd != 0.0 && side != 0.0) { // Diagonals are not faster
+    fwd *= M_SQRT1_2;
+    side *= M_SQRT1_2;
+  }
+  move_player(params,
+              (cos(p->direction) * fwd - sin(p->direction) * side) * step,
+              (sin(p->direction) * fwd + cos(p->direction) * side) * step);
+  params->sim.time_us += SIM_TICK_US;
+  doors_update(params, params->sim.time_us);
+  params->sim.stats.ticks++;
+  replay_after_tick(params);
+}
+
+/**
+ * Runs the ticks due by now_us. Call with world_lock held.
+ */
+void sim_update(t_params *params, long now_us) {
+  t_sim *s = &params->sim;
+  int ticks = 0;
+
+  if (s->last_wall_us == 0) {
+    s->last_wall_us = now_us;
+    s->tick_wall_us = now_us;
+    s->prev = params->player;
+  }
+  s->acc_us += now_us - s->last_wall_us;
+  s->last_wall_us = now_us;
+  s->clock_skew_us = now_us - get_time_us();
+  while (s->acc_us >= SIM_TICK_US) {
+    if (ticks == SIM_MAX_TICKS) {
+      s->stats.dropped_ticks += s->acc_us / SIM_TICK_US;
+      s->acc_us %= SIM_TICK_US;
+      break;
+    }
+    s->prev = params->player;
+    sim_tick(params);
+    s->acc_us -= SIM_TICK_US;
+    ticks++;
+  }
+  s->tick_wall_us = now_us - s->acc_us;
+  s->stats.updates++;
+  s->stats.max_ticks = (ticks > s->stats.max_ticks) ? ticks : s->stats.max_ticks;
+}
+
+/**
+ * The current time on the clock sim_update runs on, for the render thread,
+ * which draws between updates. Call with world_lock held.
+ */
+long sim_clock(t_params *params) {
+  return get_time_us() + params->sim.clock_skew_us;
+}
+
+/**
+ * The player posed between the last two ticks as of now_us. Call with
+ * world_lock held.
+ */
+t_player sim_pose_at(t_params *params, long now_us) {
+  t_sim *s = &params->sim;
+  t_player pose = params->player;
+  double alpha = (double)(now_us - s->tick_wall_us) / SIM_TICK_US;
+  double turn;
+
+  if (s->last_wall_us != 0) {
+    alpha = (alpha < 0.0) ? 0.0 : (alpha > 1.0 ? 1.0 : alpha);
+    turn = normalize_angle(pose.direction - s->prev.direction + M_PI) - M_PI;
+    pose.x = s->prev.x + (params->player.x - s->prev.x) * alpha;
+    pose.y = s->prev.y + (params->player.y - s->prev.y) * alpha;
+    pose.direction = normalize_angle(s->prev.direction + turn * alpha);
+  }
+  return pose;
+}
+
+/**
+ * Renders with the player posed by sim_pose_at, then restores the
+ * simulated pose. The single-threaded counterpart of view_sync.
+ */
+void render_interpolated(t_params *params, t_ray_hit *ray_hits, long now_us) {
+  t_player sim_pose = params->player;
+
+  params->player = sim_pose_at(params, now_us);
+  render_frame(params, ray_hits);
+  params->player = sim_pose;
+}
+
+void sim_report(t_params *params) {
+  t_sim_stats *s = &params->sim.stats;
+
+  if (s->updates == 0)
+    return;
+  fprintf(stderr,
+          "sim: %lu ticks at %d Hz, %.2f ticks/update (max %d), "
+          "%lu ticks dropped\n",
+          s->ticks, SIM_HZ, (double)s->ticks / s->updates, s->max_ticks,
+          s->dropped_ticks);
+}
@@ -0,0 +1,138 @@
+#include "../../include/cub3d.h"
+
+// --- World Setup ---
+//
+// Builds the game state from a map layout, one string per row: '1' walls,
+// '0' floor, 'D' doors, '2' lamp sprites and one of NSEW for the player.
+// Shared by the game, the headless modes and the tests, so all of them
+// render the same world for the same layout.
+
+// Places a sprite or the player found at (x, y) and clears the cell.
+static int load_cell(t_params *params, int x, int y, bool *player_found) {
+  char cell = params->map.map_data[y][x];
+
+  if (cell == SPRITE) {
+    if (sprite_add(params, (x + 0.5) * TILE_SIZE, (y + 0.5) * TILE_SIZE,
+                   x + y) < 0) {
+      perror("Error allocating sprite");
+      return -1;
+    }
+  } else if (strchr("NSEW", cell) && *player_found) {
+    fprintf(stderr, "Error: Multiple player start positions.\n");
+    return -1;
+  } else if (strchr("NSEW", cell)) {
+    params->player.x = (x + 0.5) * TILE_SIZE;
+    params->player.y = (y + 0.5) * TILE_SIZE;
+    if (cell == PLAYER_NORTH)
+      params->player.direction = 3.0 * M_PI / 2.0;
+    else if (cell == PLAYER_SOUTH)
+      params->player.direction = M_PI / 2.0;
+    else if (cell == PLAYER_EAST)
+      params->player.direction = 0.0;
+    else
+      params->player.direction = M_PI;
+    *player_found = true;
+  } else
+    return 0;
+  params->map.map_data[y][x] = EMPTY;
+  return 0;
+}
+
+static bool is_enclosed(t_map *map) {
+  int x, y;
+
+  for (x = 0; x < map->cols; x++)
+    if (map->map_data[0][x] != WALL || map->map_data[map->rows - 1][x] != WALL)
+      return false;
+  for (y = 0; y < map->rows; y++)
+    if (map->map_data[y][0] != WALL || map->map_data[y][map->cols - 1] != WALL)
+      return false;
+  return true;
+}
+
+// Copies and checks the layout into params->map, placing player and sprites.
+static int load_map(t_params *params, const char *const *layout, int rows) {
+  int cols = (rows > 0) ? (int)ft_strlen(layout[0]) : 0;
+  bool player_found = false;
+  int x, y;
+
+  if (rows < 3 || cols < 3) {
+    fprintf(stderr, "Error: Map is too small.\n");
+    return -1;
+  }
+  params->map.map_data = ft_calloc(rows, sizeof(char *));
+  if (!params->map.map_data) {
+    perror("Error allocating map rows");
+    return -1;
+  }
+  params->map.rows = rows;
+  params->map.cols = cols;
+  for (y = 0; y < rows; y++) {
+    if ((int)ft_strlen(layout[y]) != cols) {
+      fprintf(stderr, "Error: Map row %d has inconsistent length.\n", y);
+      return -1;
+    }
+    params->map.map_data[y] = ft_strdup(layout[y]);
+    if (!params->map.map_data[y]) {
+      perror("Error allocating map row");
+      return -1;
+    }
+    for (x = 0; x < cols; x++) {
+      if (strchr("012DNSEW ", layout[y][x]) == NULL) { // Allow space?
+        fprintf(stderr, "Error: Invalid map character '%c' at (%d, %d).\n",
+                layout[y][x], x, y);
+        return -1;
+      }
+      if (load_cell(params, x, y, &player_found) != 0)
+        return -1;
+    }
+  }
+  if (!player_found) {
+    fprintf(stderr, "Error: No player start position found.\n");
+    return -1;
+  }
+  if (!is_enclosed(&params->map)) {
+    fprintf(stderr, "Error: Map must be enclosed by walls ('1').\n");
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Loads layout into a zeroed params and sets up everything the renderer
+ * and simulation need, short of a window and an image to draw into.
+ *
+ * @return 0 on success, -1 after printing the reason; world_free then
+ *         releases whatever was set up
+ */
+int world_load(t_params *params, const char *const *layout, int rows) {
+  if (load_map(params, layout, rows) != 0)
+    return -1;
+  if (cells_init(params) != 0 || minimap_init(params) != 0 ||
+      sprites_init(params) != 0 || lighting_init(params) != 0 ||
+      render_init(params) != 0) {
+    perror("Error allocating map state, minimap, sprites or lightmap");
+    return -1;
+  }
+  params->player.fov = PLAYER_FOV;
+  params->post.flags = POST_ALL;
+  params->dist_proj_plane = (WINDOW_WIDTH / 2.0) / tan(PLAYER_FOV / 2.0);
+  return 0;
+}
+
+void world_free(t_params *params) {
+  int y;
+
+  minimap_free(params);
+  interlace_free(params);
+  render_free(params);
+  lighting_free(params);
+  sprites_free(params);
+  cells_free(params);
+  if (params->map.map_data) {
+    for (y = 0; y < params->map.rows; y++)
+      free(params->map.map_data[y]);
+    free(params->map.map_data);
+    params->map.map_data = NULL;
+  }
+}
@@ -0,0 +1,97 @@
+#include "../../include/cub3d.h"
+
+// --- Triangle Fan Scanline Filler ---
+//
+// Pixels are sampled at their centres with half-open spans, and edges are
+// always evaluated top to bottom. Two triangles sharing an edge therefore
+// split the pixels on it exactly, so every covered pixel is blended once.
+
+// Divides the two 16-bit lanes of x by 255, rounded to nearest.
+static inline unsigned int div255_lanes(unsigned int x) {
+  x += 0x00800080;
+  return ((x + ((x >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static inline unsigned int blend_pixel(unsigned int dst, unsigned int src,
+                                       unsigned int alpha) {
+  unsigned int inv = 255 - alpha;
+  unsigned int rb = (src & 0xFF00FF) * alpha + (dst & 0xFF00FF) * inv;
+  unsigned int g = ((src >> 8) & 0xFF) * alpha + ((dst >> 8) & 0xFF) * inv;
+
+  return div255_lanes(rb) | (div255_lanes(g) << 8);
+}
+
+static inline void sort_by_y(t_fpoint *a, t_fpoint *b) {
+  t_fpoint tmp;
+
+  if (b->y < a->y || (b->y == a->y && b->x < a->x)) {
+    tmp = *a;
+    *a = *b;
+    *b = tmp;
+  }
+}
+
+static inline float edge_x(t_fpoint top, t_fpoint bottom, float yc) {
+  return top.x + (yc - top.y) * (bottom.x - top.x) / (bottom.y - top.y);
+}
+
+static void fill_span(t_img *img, const t_fan *fan, int y, float xl,
+                      float xr) {
+  unsigned int *row;
+  int x0 = (int)ceilf(xl - 0.5f);
+  int x1 = (int)ceilf(xr - 0.5f); // Exclusive
+  int x;
+
+  if (x0 < 0)
+    x0 = 0;
+  if (x1 > fan->clip_w)
+    x1 = fan->clip_w;
+  row = (unsigned int *)(img->addr + y * img->line_length);
+  COUNT_MINIMAP((x1 > x0) ? x1 - x0 : 0);
+  if (fan->alpha >= 255) {
+    for (x = x0; x < x1; x++)
+      row[x] = fan->color;
+    return;
+  }
+  for (x = x0; x < x1; x++)
+    row[x] = blend_pixel(row[x], fan->color, fan->alpha);
+}
+
+static void fill_triangle(t_img *img, const t_fan *fan, t_fpoint v0,
+                          t_fpoint v1, t_fpoint v2) {
+  float yc, xa, xb;
+  int y, y0, y1;
+
+  sort_by_y(&v0, &v1);
+  sort_by_y(&v1, &v2);
+  sort_by_y(&v0, &v1);
+  y0 = (int)ceilf(v0.y - 0.5f);
+  y1 = (int)ceilf(v2.y - 0.5f); // Exclusive
+  if (y0 < 0)
+    y0 = 0;
+  if (y1 > fan->clip_h)
+    y1 = fan->clip_h;
+  for (y = y0; y < y1; y++) {
+    yc = y + 0.5f;
+    xa = edge_x(v0, v2, yc);
+    xb = (yc < v1.y) ? edge_x(v0, v1, yc) : edge_x(v1, v2, yc);
+    if (xa < xb)
+      fill_span(img, fan, y, xa, xb);
+    else
+      fill_span(img, fan, y, xb, xa);
+  }
+}
+
+/**
+ * Fills the fan (center, rim[i], rim[i + 1]) for i in [0, count - 1),
+ * clipped to [0, clip_w) x [0, clip_h) of a 32bpp image. Pixels are
+ * blended with the fan colour at alpha / 255 opacity, rounded per channel.
+ */
+void fill_triangle_fan(t_img *img, const t_fan *fan) {
+  int i;
+
+  if (img->bpp != 4 || fan->count < 2 || fan->alpha <= 0)
+    return;
+  for (i = 0; i + 1 < fan->count; i++)
+    fill_triangle(img, fan, fan->center, fan->rim[i], fan->rim[i + 1]);
+}
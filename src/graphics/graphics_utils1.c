@@ -24,158 +24,181 @@ int	put_pixel(t_params *params, int x, int y, int color)
 	return (0);
 }
 
-// void	bresenham_algorithm(t_point p1, t_point p2, t_point *delta,
-// 		t_point *sign)
-// {
-// 	delta->x = abs(p2.x - p1.x);
-// 	delta->y = -abs(p2.y - p1.y);
-// 	if (p1.x < p2.x)
-// 		sign->x = 1;
-// 	else
-// 		sign->x = -1;
-// 	if (p1.y < p2.y)
-// 		sign->y = 1;
-// 	else
-// 		sign->y = -1;
-// }
-
-// void	draw_line(t_params *params, t_point p1, t_point p2, int color)
-// {
-// 	t_point	d;
-// 	t_point	s;
-// 	int		err;
-// 	int		e2;
-
-// 	bresenham_algorithm(p1, p2, &d, &s);
-// 	err = d.x + d.y;
-// 	while (1)
-// 	{
-// 		mlx_pixel_put(params->mlx, params->win, p1.x, p1.y, color);
-// 		if (p1.x == p2.x && p1.y == p2.y)
-// 			break ;
-// 		e2 = 2 * err;
-// 		if (e2 >= d.y)
-// 		{
-// 			err += d.y;
-// 			p1.x += s.x;
-// 		}
-// 		if (e2 <= d.x)
-// 		{
-// 			err += d.x;
-// 			p1.y += s.y;
-// 		}
-// 	}
-// }
-
-// void	draw_line_img(t_params *params, t_point p1, t_point p2, int color)
-// {
-// 	t_point	d;
-// 	t_point	s;
-// 	int		err;
-// 	int		e2;
-
-// 	bresenham_algorithm(p1, p2, &d, &s);
-// 	err = d.x + d.y;
-// 	while (1)
-// 	{
-// 		put_pixel(params, p1.x, p1.y, color);
-// 		if (p1.x == p2.x && p1.y == p2.y)
-// 			break ;
-// 		e2 = 2 * err;
-// 		if (e2 >= d.y)
-// 		{
-// 			err += d.y;
-// 			p1.x += s.x;
-// 		}
-// 		if (e2 <= d.x)
-// 		{
-// 			err += d.x;
-// 			p1.y += s.y;
-// 		}
-// 	}
-// }
-
-void	draw_line(t_params *params, t_point p1, t_point p2, int color)
+void	bresenham_algorithm(t_point p1, t_point p2, t_point *delta,
+		t_point *sign)
 {
-	float	deltaX;
-	float	deltaY;
-	float	longestSideLength;
-	float	xIncrement;
-	float	yIncrement;
-	float	currentX;
-	float	currentY;
-	int		steps;
-
-	deltaX = (float)(p2.x - p1.x);
-	deltaY = (float)(p2.y - p1.y);
-	if (fabsf(deltaX) >= fabsf(deltaY))
-	{
-		longestSideLength = fabsf(deltaX);
-	}
+	delta->x = abs(p2.x - p1.x);
+	delta->y = -abs(p2.y - p1.y);
+	if (p1.x < p2.x)
+		sign->x = 1;
 	else
-	{
-		longestSideLength = fabsf(deltaY);
-	}
-	if (longestSideLength == 0)
-	{
-		xIncrement = 0;
-		yIncrement = 0;
-	}
+		sign->x = -1;
+	if (p1.y < p2.y)
+		sign->y = 1;
 	else
-	{
-		xIncrement = deltaX / longestSideLength;
-		yIncrement = deltaY / longestSideLength;
-	}
-	currentX = (float)p1.x;
-	currentY = (float)p1.y;
-	steps = (int)(longestSideLength + 0.5f);
-	for (int i = 0; i <= steps; i++)
-	{
-		mlx_pixel_put(params->mlx, params->win, (int)roundf(currentX),
-			(int)roundf(currentY), color);
-		currentX += xIncrement;
-		currentY += yIncrement;
-	}
+		sign->y = -1;
 }
 
-void	draw_line_img(t_params *params, t_point p1, t_point p2, int color)
+/*
+ * Cohen-Sutherland region code of a point against [0, w) x [0, h).
+ */
+static int	outcode(t_point p, int w, int h)
 {
-	float	deltaX;
-	float	deltaY;
-	float	longestSideLength;
-	float	xIncrement;
-	float	yIncrement;
-	float	currentX;
-	float	currentY;
-	int		steps;
-
-	deltaX = (float)(p2.x - p1.x);
-	deltaY = (float)(p2.y - p1.y);
-	if (fabsf(deltaX) >= fabsf(deltaY))
+	int	code;
+
+	code = OUT_INSIDE;
+	if (p.x < 0)
+		code |= OUT_LEFT;
+	else if (p.x >= w)
+		code |= OUT_RIGHT;
+	if (p.y < 0)
+		code |= OUT_TOP;
+	else if (p.y >= h)
+		code |= OUT_BOTTOM;
+	return (code);
+}
+
+static t_point	clip_point(t_point p1, t_point p2, int code, t_point size)
+{
+	t_point	out;
+	long	dx;
+	long	dy;
+
+	dx = p2.x - p1.x;
+	dy = p2.y - p1.y;
+	if (code & OUT_TOP || code & OUT_BOTTOM)
 	{
-		longestSideLength = fabsf(deltaX);
+		out.y = 0;
+		if (code & OUT_BOTTOM)
+			out.y = size.y - 1;
+		out.x = p1.x + lround((double)(dx * (out.y - p1.y)) / dy);
 	}
 	else
 	{
-		longestSideLength = fabsf(deltaY);
+		out.x = 0;
+		if (code & OUT_RIGHT)
+			out.x = size.x - 1;
+		out.y = p1.y + lround((double)(dy * (out.x - p1.x)) / dx);
 	}
-	if (longestSideLength == 0)
+	return (out);
+}
+
+/*
+ * Clips the segment to [0, w) x [0, h) in place with integer
+ * Cohen-Sutherland. Returns false when nothing of it is visible.
+ */
+bool	clip_line(t_point *p1, t_point *p2, int w, int h)
+{
+	int	code1;
+	int	code2;
+
+	code1 = outcode(*p1, w, h);
+	code2 = outcode(*p2, w, h);
+	while (code1 | code2)
 	{
-		xIncrement = 0;
-		yIncrement = 0;
+		if (code1 & code2)
+			return (false);
+		if (code1)
+		{
+			*p1 = clip_point(*p1, *p2, code1, (t_point){w, h});
+			code1 = outcode(*p1, w, h);
+		}
+		else
+		{
+			*p2 = clip_point(*p1, *p2, code2, (t_point){w, h});
+			code2 = outcode(*p2, w, h);
+		}
 	}
-	else
+	return (true);
+}
+
+/*
+ * Draws a line into the window through the batched segment path: one X
+ * request for the whole line instead of one XDrawPoint per pixel.
+ */
+void	draw_line(t_params *params, t_point p1, t_point p2, int color)
+{
+	t_point	ends[2];
+
+	ends[0] = p1;
+	ends[1] = p2;
+	draw_segments(params, ends, 1, color);
+}
+
+/*
+ * Draws count segments (ends[2 * i], ends[2 * i + 1]) into the window,
+ * clipped to it, sending them in as few XDrawSegments requests as
+ * possible.
+ */
+void	draw_segments(t_params *params, const t_point *ends, int count,
+		int color)
+{
+	int		coords[SEGMENT_BATCH * 4];
+	int		n;
+	t_point	a;
+	t_point	b;
+
+	n = 0;
+	while (count-- > 0)
 	{
-		xIncrement = deltaX / longestSideLength;
-		yIncrement = deltaY / longestSideLength;
+		a = *ends++;
+		b = *ends++;
+		if (!clip_line(&a, &b, WINDOW_WIDTH, WINDOW_HEIGHT))
+			continue ;
+		coords[n * 4] = a.x;
+		coords[n * 4 + 1] = a.y;
+		coords[n * 4 + 2] = b.x;
+		coords[n * 4 + 3] = b.y;
+		if (++n == SEGMENT_BATCH)
+		{
+			window_draw_segments(params->mlx, params->win, coords, n, color);
+			n = 0;
+		}
 	}
-	currentX = (float)p1.x;
-	currentY = (float)p1.y;
-	steps = (int)(longestSideLength + 0.5f);
-	for (int i = 0; i <= steps; i++)
+	if (n > 0)
+		window_draw_segments(params->mlx, params->win, coords, n, color);
+}
+
+/*
+ * Integer Bresenham into window_img. The segment is clipped first, so
+ * the loop writes straight to the framebuffer without bounds checks.
+ */
+void	draw_line_img(t_params *params, t_point p1, t_point p2, int color)
+{
+	t_point	d;
+	t_point	s;
+	t_point	step;
+	char	*dst;
+	int		err;
+	int		e2;
+
+	if (!clip_line(&p1, &p2, params->window_img.width,
+			params->window_img.height))
+		return ;
+	bresenham_algorithm(p1, p2, &d, &s);
+	step.x = s.x * params->window_img.bpp;
+	step.y = s.y * params->window_img.line_length;
+	dst = params->window_img.addr + p1.y * params->window_img.line_length
+		+ p1.x * params->window_img.bpp;
+	COUNT_MINIMAP(1 + ((d.x > -d.y) ? d.x : -d.y));
+	err = d.x + d.y;
+	while (1)
 	{
-		put_pixel(params, (int)roundf(currentX), (int)roundf(currentY), color);
-		currentX += xIncrement;
-		currentY += yIncrement;
+		*(unsigned int *)dst = color;
+		if (p1.x == p2.x && p1.y == p2.y)
+			break ;
+		e2 = 2 * err;
+		if (e2 >= d.y)
+		{
+			err += d.y;
+			p1.x += s.x;
+			dst += step.x;
+		}
+		if (e2 <= d.x)
+		{
+			err += d.x;
+			p1.y += s.y;
+			dst += step.y;
+		}
 	}
 }
@@ -20,49 +20,44 @@
 	 return (sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2)));
  }
 
+ // Grid lines crossed by one of the two walks of a ray. Crossings are
+ // recomputed from the player position for every line instead of being
+ // accumulated, and the cell comes from the line index, so a far wall is
+ // no less exact than a near one (a float position nudged past the line
+ // rounds back onto it once coordinates reach a few thousand).
+ typedef struct s_grid_walk
+ {
+	 int		line;   // Index of the next grid line the ray crosses
+	 int		dir;    // 1 when line indices grow along the ray, -1 if not
+	 double	slope;  // Movement along the lines per unit across them
+ }	t_grid_walk;
+
  /**
-  * Sets up the initial position and step values for a ray checking horizontal wall intersections.
-  * Horizontal intersections occur when the ray crosses a horizontal grid line.
+  * Sets up the walk of a ray across horizontal grid lines.
   *
   * @param params Game parameters containing player position and map data
   * @param ray_angle The angle at which the ray is cast (in radians)
-  * @param ray_pos Pointer to store the initial ray position
-  * @param ray_step Pointer to store the step values for ray advancement
+  * @param walk Filled with the first line, direction and slope
+  * @return false if the ray is horizontal and crosses no horizontal line
   */
- static void initialize_horizontal_ray_intersection(t_params *params, double ray_angle,
-		 t_fpoint *ray_pos, t_fpoint *ray_step)
+ static bool initialize_horizontal_ray_intersection(t_params *params,
+		 double ray_angle, t_grid_walk *walk)
  {
-	 double inverse_tangent;
-
-	 // Initialize ray position to invalid values
-	 ray_pos->x = INT_MAX;
-	 ray_pos->y = INT_MAX;
-
 	 // If the ray is perfectly horizontal, there are no horizontal intersections
 	 if (ray_angle == 0 || ray_angle == M_PI || ray_angle == 2 * M_PI)
-		 return;
+		 return (false);
 
-	 // For rays pointing downward (0 to PI)
-	 else if (ray_angle > 0 && ray_angle < M_PI)
+	 walk->line = (int)params->player.y / TILE_SIZE;
+	 // For rays pointing downward (0 to PI) the first line is below the player
+	 if (ray_angle > 0 && ray_angle < M_PI)
 	 {
-		 // Find the next horizontal grid line below the player
-		 ray_pos->y = (((int)params->player.y / TILE_SIZE) * TILE_SIZE) + TILE_SIZE;
-		 ray_step->y = TILE_SIZE;  // Move down one tile at a time
+		 walk->line++;
+		 walk->dir = 1;
 	 }
-	 // For rays pointing upward (PI to 2*PI)
 	 else
-	 {
-		 // Find the next horizontal grid line above the player (subtract small value to ensure we're above the line)
-		 ray_pos->y = (((int)params->player.y / TILE_SIZE) * TILE_SIZE) - 0.0001;
-		 ray_step->y = -TILE_SIZE;  // Move up one tile at a time
-	 }
-
-	 // Calculate the corresponding x-coordinate using the inverse tangent
-	 inverse_tangent = 1.0 / tan(ray_angle);
-	 ray_pos->x = params->player.x + (ray_pos->y - params->player.y) * inverse_tangent;
-
-	 // Calculate x step based on y step and angle
-	 ray_step->x = ray_step->y * inverse_tangent;
+		 walk->dir = -1;
+	 walk->slope = 1.0 / tan(ray_angle);
+	 return (true);
  }
 
  /**
@@ -75,87 +70,73 @@
   */
  t_fpoint find_horizontal_wall_intersection(t_params *params, double ray_angle)
  {
-	 t_fpoint ray_position;     // Current position of the ray
-	 t_fpoint ray_step;         // Step values for advancing the ray
+	 t_grid_walk walk;          // Grid lines still to cross
 	 t_point map_cell;          // Map grid cell indices
-
-	 // Set up initial ray position and step values
-	 initialize_horizontal_ray_intersection(params, ray_angle, &ray_position, &ray_step);
+	 t_fpoint door_hit;         // Crossing of a door cell's middle line
+	 double x;
+	 double y;
 
 	 // If ray is perfectly horizontal, no horizontal intersections possible
-	 if (ray_position.x == INT_MAX && ray_position.y == INT_MAX)
-		 return (ray_position);
-
-	 // Convert ray position to map grid indices
-	 map_cell.x = (int)ray_position.x / TILE_SIZE;
-	 map_cell.y = (int)ray_position.y / TILE_SIZE;
+	 if (!initialize_horizontal_ray_intersection(params, ray_angle, &walk))
+		 return ((t_fpoint){INT_MAX, INT_MAX});
 
 	 // Continue until ray goes out of map bounds
-	 while (map_cell.x >= 0 && map_cell.x < params->map.cols &&
-			map_cell.y >= 0 && map_cell.y < params->map.rows)
+	 while (1)
 	 {
+		 y = (double)walk.line * TILE_SIZE;
+		 x = params->player.x + (y - params->player.y) * walk.slope;
+		 // Cell beyond the line, on the ray's side of it
+		 map_cell.x = (int)floor(x / TILE_SIZE);
+		 map_cell.y = (walk.dir > 0) ? walk.line : walk.line - 1;
+		 if (map_cell.x < 0 || map_cell.x >= params->map.cols ||
+			 map_cell.y < 0 || map_cell.y >= params->map.rows)
+			 break ;
+		 COUNT_STEP();
 		 // Check if ray has hit a wall (represented by '1' in map data)
 		 if (params->map.map_data[map_cell.y][map_cell.x] == '1')
-			 return (ray_position);
-
-		 // Move ray to next potential intersection
-		 ray_position.x += ray_step.x;
-		 ray_position.y += ray_step.y;
-
-		 // Update grid indices based on new ray position
-		 map_cell.x = (int)ray_position.x / TILE_SIZE;
-		 map_cell.y = (int)ray_position.y / TILE_SIZE;
+			 return ((t_fpoint){x, y});
+
+		 // Doors are thin slabs halfway to the next grid line
+		 if (params->map.map_data[map_cell.y][map_cell.x] == DOOR)
+		 {
+			 door_hit.y = y + walk.dir * TILE_SIZE / 2.0;
+			 door_hit.x = x + walk.dir * TILE_SIZE / 2.0 * walk.slope;
+			 if (door_blocks_ray(params, map_cell.x, map_cell.y, false, door_hit))
+				 return (door_hit);
+		 }
+		 walk.line += walk.dir;
 	 }
 
 	 // If no intersection found within map bounds, mark as invalid
-	 ray_position.x = INT_MAX;
-	 ray_position.y = INT_MAX;
-	 return (ray_position);
+	 return ((t_fpoint){INT_MAX, INT_MAX});
  }
 
  /**
-  * Sets up the initial position and step values for a ray checking vertical wall intersections.
-  * Vertical intersections occur when the ray crosses a vertical grid line.
+  * Sets up the walk of a ray across vertical grid lines.
   *
   * @param params Game parameters containing player position and map data
   * @param ray_angle The angle at which the ray is cast (in radians)
-  * @param ray_pos Pointer to store the initial ray position
-  * @param ray_step Pointer to store the step values for ray advancement
+  * @param walk Filled with the first line, direction and slope
+  * @return false if the ray is vertical and crosses no vertical line
   */
- static void initialize_vertical_ray_intersection(t_params *params, double ray_angle,
-		 t_fpoint *ray_pos, t_fpoint *ray_step)
+ static bool initialize_vertical_ray_intersection(t_params *params,
+		 double ray_angle, t_grid_walk *walk)
  {
-	 double tangent;
-
-	 // Initialize ray position to invalid values
-	 ray_pos->x = INT_MAX;
-	 ray_pos->y = INT_MAX;
-
 	 // If the ray is perfectly vertical, there are no vertical intersections
 	 if (ray_angle == M_PI / 2 || ray_angle == 3 * M_PI / 2)
-		 return;
+		 return (false);
 
-	 // For rays pointing left (PI/2 to 3*PI/2)
-	 else if (ray_angle > M_PI / 2 && ray_angle < 3 * M_PI / 2)
-	 {
-		 // Find the next vertical grid line to the left of the player (subtract small value to ensure we're left of the line)
-		 ray_pos->x = (((int)params->player.x / TILE_SIZE) * TILE_SIZE) - 0.0001;
-		 ray_step->x = -TILE_SIZE;  // Move left one tile at a time
-	 }
-	 // For rays pointing right (0 to PI/2 or 3*PI/2 to 2*PI)
+	 walk->line = (int)params->player.x / TILE_SIZE;
+	 // For rays pointing left (PI/2 to 3*PI/2) the first line is the player's
+	 if (ray_angle > M_PI / 2 && ray_angle < 3 * M_PI / 2)
+		 walk->dir = -1;
 	 else
 	 {
-		 // Find the next vertical grid line to the right of the player
-		 ray_pos->x = (((int)params->player.x / TILE_SIZE) * TILE_SIZE) + TILE_SIZE;
-		 ray_step->x = TILE_SIZE;  // Move right one tile at a time
+		 walk->line++;
+		 walk->dir = 1;
 	 }
-
-	 // Calculate the corresponding y-coordinate using the tangent
-	 tangent = tan(ray_angle);
-	 ray_pos->y = params->player.y + (ray_pos->x - params->player.x) * tangent;
-
-	 // Calculate y step based on x step and angle
-	 ray_step->y = ray_step->x * tangent;
+	 walk->slope = tan(ray_angle);
+	 return (true);
  }
 
  /**
@@ -168,40 +149,43 @@
   */
  t_fpoint find_vertical_wall_intersection(t_params *params, double ray_angle)
  {
-	 t_fpoint ray_position;     // Current position of the ray
-	 t_fpoint ray_step;         // Step values for advancing the ray
+	 t_grid_walk walk;          // Grid lines still to cross
 	 t_point map_cell;          // Map grid cell indices
-
-	 // Set up initial ray position and step values
-	 initialize_vertical_ray_intersection(params, ray_angle, &ray_position, &ray_step);
+	 t_fpoint door_hit;         // Crossing of a door cell's middle line
+	 double x;
+	 double y;
 
 	 // If ray is perfectly vertical, no vertical intersections possible
-	 if (ray_position.x == INT_MAX && ray_position.y == INT_MAX)
-		 return (ray_position);
-
-	 // Convert ray position to map grid indices
-	 map_cell.x = (int)ray_position.x / TILE_SIZE;
-	 map_cell.y = (int)ray_position.y / TILE_SIZE;
+	 if (!initialize_vertical_ray_intersection(params, ray_angle, &walk))
+		 return ((t_fpoint){INT_MAX, INT_MAX});
 
 	 // Continue until ray goes out of map bounds
-	 while (map_cell.x >= 0 && map_cell.x < params->map.cols &&
-			map_cell.y >= 0 && map_cell.y < params->map.rows)
+	 while (1)
 	 {
+		 x = (double)walk.line * TILE_SIZE;
+		 y = params->player.y + (x - params->player.x) * walk.slope;
+		 // Cell beyond the line, on the ray's side of it
+		 map_cell.x = (walk.dir > 0) ? walk.line : walk.line - 1;
+		 map_cell.y = (int)floor(y / TILE_SIZE);
+		 if (map_cell.x < 0 || map_cell.x >= params->map.cols ||
+			 map_cell.y < 0 || map_cell.y >= params->map.rows)
+			 break ;
+		 COUNT_STEP();
 		 // Check if ray has hit a wall (represented by '1' in map data)
 		 if (params->map.map_data[map_cell.y][map_cell.x] == '1')
-			 return (ray_position);
-
-		 // Move ray to next potential intersection
-		 ray_position.x += ray_step.x;
-		 ray_position.y += ray_step.y;
-
-		 // Update grid indices based on new ray position
-		 map_cell.x = (int)ray_position.x / TILE_SIZE;
-		 map_cell.y = (int)ray_position.y / TILE_SIZE;
+			 return ((t_fpoint){x, y});
+
+		 // Doors are thin slabs halfway to the next grid line
+		 if (params->map.map_data[map_cell.y][map_cell.x] == DOOR)
+		 {
+			 door_hit.x = x + walk.dir * TILE_SIZE / 2.0;
+			 door_hit.y = y + walk.dir * TILE_SIZE / 2.0 * walk.slope;
+			 if (door_blocks_ray(params, map_cell.x, map_cell.y, true, door_hit))
+				 return (door_hit);
+		 }
+		 walk.line += walk.dir;
 	 }
 
 	 // If no intersection found within map bounds, mark as invalid
-	 ray_position.x = INT_MAX;
-	 ray_position.y = INT_MAX;
-	 return (ray_position);
+	 return ((t_fpoint){INT_MAX, INT_MAX});
  }
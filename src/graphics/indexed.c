@@ -0,0 +1,379 @@
+#include "../../include/cub3d.h"
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+// --- Palette-Indexed Rendering ---
+//
+// Optional 8-bit path for the 3D view. The wall textures and the sky are
+// quantized to a 256-colour palette when the renderer starts, and walls
+// are shaded through remap tables: remap[level][index] is the palette
+// entry closest to colour index at brightness level. The wall pass then
+// writes one byte per pixel into pixels, a quarter of the bandwidth of
+// the 32-bit path, and indexed_expand turns the finished view into 32bpp
+// window_img before sprites and post-processing run as usual.
+//
+// The palette is a median cut over an RGB555 histogram of every texel
+// at a few brightness levels, so dark shades get entries too. Entry 0 is
+// black, which is what distant floor and ceiling shade to.
+
+#define RGB555_COLORS 32768
+#define SHADE_SAMPLES 5
+
+typedef struct s_box {
+  int first; // Range of the bins array
+  int count;
+  long weight;
+} t_box;
+
+static int rgb555(unsigned int color) {
+  return ((color >> 9) & 0x7C00) | ((color >> 6) & 0x03E0) |
+         ((color >> 3) & 0x001F);
+}
+
+static int channel(int bin, int shift) {
+  int c = (bin >> shift) & 31;
+
+  return (c << 3) | (c >> 2);
+}
+
+static void add_texels(unsigned int *hist, const unsigned int *texels,
+                       size_t count, size_t stride) {
+  static const unsigned int levels[SHADE_SAMPLES] = {256, 192, 128, 72, 32};
+  size_t i;
+  int l;
+
+  for (i = 0; i < count; i += stride)
+    for (l = 0; l < SHADE_SAMPLES; l++)
+      hist[rgb555(shade_color(texels[i], levels[l]))]++;
+}
+
+// Channel shift (10 red, 5 green, 0 blue) with the widest range in box;
+// hi receives that channel's largest 5-bit value.
+static int widest_channel(const int *bins, const t_box *box, int *hi) {
+  int lo[3] = {31, 31, 31}, top[3] = {0, 0, 0}, c, i, v, best = 0;
+
+  for (i = 0; i < box->count; i++)
+    for (c = 0; c < 3; c++) {
+      v = (bins[box->first + i] >> (c * 5)) & 31;
+      lo[c] = (v < lo[c]) ? v : lo[c];
+      top[c] = (v > top[c]) ? v : top[c];
+    }
+  for (c = 1; c < 3; c++)
+    if (top[c] - lo[c] > top[best] - lo[best])
+      best = c;
+  *hi = (top[best] > lo[best]) ? top[best] : -1;
+  return best * 5;
+}
+
+/**
+ * Splits the box at the weighted median of its widest channel, moving
+ * the bins at or below the cut to the front.
+ *
+ * @return false if every bin of the box has the same colour
+ */
+static bool split_box(const unsigned int *hist, int *bins, t_box *box,
+                      t_box *out) {
+  long weight[32] = {0}, below = 0;
+  int *b = bins + box->first, shift, hi, cut, i, j, tmp;
+
+  shift = widest_channel(bins, box, &hi);
+  if (hi < 0)
+    return false;
+  for (i = 0; i < box->count; i++)
+    weight[(b[i] >> shift) & 31] += hist[b[i]];
+  for (cut = 0; cut < hi - 1; cut++) {
+    below += weight[cut];
+    if (below * 2 >= box->weight)
+      break;
+  }
+  if (cut == hi - 1)
+    below += weight[cut];
+  for (i = 0, j = box->count - 1; i <= j;) {
+    if (((b[i] >> shift) & 31) <= cut) {
+      i++;
+      continue;
+    }
+    tmp = b[i];
+    b[i] = b[j];
+    b[j--] = tmp;
+  }
+  out->first = box->first + i;
+  out->count = box->count - i;
+  out->weight = box->weight - below;
+  box->count = i;
+  box->weight = below;
+  return true;
+}
+
+static unsigned int box_color(const unsigned int *hist, const int *bins,
+                              const t_box *box) {
+  double sum[3] = {0, 0, 0};
+  int i, c;
+
+  for (i = 0; i < box->count; i++)
+    for (c = 0; c < 3; c++)
+      sum[c] += (double)hist[bins[box->first + i]] *
+                channel(bins[box->first + i], c * 5);
+  for (c = 0; c < 3; c++)
+    sum[c] = sum[c] / box->weight + 0.5;
+  return ((unsigned int)sum[2] << 16) | ((unsigned int)sum[1] << 8) |
+         (unsigned int)sum[0];
+}
+
+/**
+ * Median cut: keeps splitting the heaviest box that can still be split
+ * until the palette is full.
+ */
+static void build_palette(t_indexed *ix, const unsigned int *hist, int *bins,
+                          t_box *boxes) {
+  int n = 0, count = 1, i, best;
+  t_box *pick;
+
+  for (i = 0; i < RGB555_COLORS; i++)
+    if (hist[i])
+      bins[n++] = i;
+  boxes[0] = (t_box){0, n, 0};
+  for (i = 0; i < n; i++)
+    boxes[0].weight += hist[bins[i]];
+  while (count < PALETTE_COLORS - 1) {
+    best = -1;
+    for (i = 0; i < count; i++)
+      if (boxes[i].count > 1 && (best < 0 || boxes[i].weight > boxes[best].weight))
+        best = i;
+    if (best < 0)
+      break;
+    pick = &boxes[best];
+    if (!split_box(hist, bins, pick, &boxes[count])) {
+      pick->count = -pick->count; // Unsplittable: hide it from the search
+      continue;
+    }
+    count++;
+  }
+  ix->palette[0] = 0x000000;
+  for (i = 0; i < count; i++) {
+    boxes[i].count = abs(boxes[i].count);
+    ix->palette[i + 1] = boxes[i].weight ? box_color(hist, bins, &boxes[i]) : 0;
+  }
+  ix->colors = count + 1;
+}
+
+static int nearest(const t_indexed *ix, unsigned int color) {
+  int r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+  int i, best = 0, d, dr, dg, db, best_d = INT_MAX;
+
+  for (i = 0; i < ix->colors; i++) {
+    dr = r - (int)((ix->palette[i] >> 16) & 0xFF);
+    dg = g - (int)((ix->palette[i] >> 8) & 0xFF);
+    db = b - (int)(ix->palette[i] & 0xFF);
+    d = 3 * dr * dr + 4 * dg * dg + 2 * db * db;
+    if (d < best_d) {
+      best_d = d;
+      best = i;
+    }
+  }
+  return best;
+}
+
+static unsigned char quantize(const t_indexed *ix, unsigned int color) {
+  return ix->inverse[rgb555(color)];
+}
+
+static int build_tables(t_params *params, unsigned int *hist) {
+  t_indexed *ix = &params->indexed;
+  int *bins = malloc(RGB555_COLORS * sizeof(*bins));
+  t_box *boxes = malloc(PALETTE_COLORS * sizeof(*boxes));
+  int i, l;
+
+  if (!bins || !boxes) {
+    free(bins);
+    free(boxes);
+    return -1;
+  }
+  build_palette(ix, hist, bins, boxes);
+  free(bins);
+  free(boxes);
+  for (i = 0; i < RGB555_COLORS; i++)
+    ix->inverse[i] = (unsigned char)nearest(
+        ix, (channel(i, 10) << 16) | (channel(i, 5) << 8) | channel(i, 0));
+  for (l = 0; l < PALETTE_LEVELS; l++)
+    for (i = 0; i < PALETTE_COLORS; i++)
+      ix->remap[l][i] = quantize(
+          ix, shade_color(ix->palette[i], l * 256 / (PALETTE_LEVELS - 1)));
+  return 0;
+}
+
+static unsigned char *quantize_texels(const t_indexed *ix,
+                                      const t_texture *tex) {
+  size_t i, n = (size_t)tex->width * tex->height;
+  unsigned char *out = malloc(n);
+
+  if (!out)
+    return NULL;
+  for (i = 0; i < n; i++)
+    out[i] = quantize(ix, tex->texels[i]);
+  return out;
+}
+
+/**
+ * Builds the palette, remap tables and indexed copies of the wall
+ * textures and sky. Needs the textures from render_init. The mode starts
+ * disabled.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int indexed_init(t_params *params) {
+  t_indexed *ix = &params->indexed;
+  unsigned int *hist = calloc(RGB555_COLORS, sizeof(*hist));
+  t_texture *tex;
+  int i;
+
+  ix->inverse = malloc(RGB555_COLORS);
+  ix->pixels = malloc((size_t)WINDOW_WIDTH * WINDOW_HEIGHT);
+  if (!hist || !ix->inverse || !ix->pixels) {
+    free(hist);
+    return -1;
+  }
+  for (i = 0; i < WALL_TEXTURES; i++) {
+    tex = &params->wall_textures[i];
+    add_texels(hist, tex->texels, (size_t)tex->width * tex->height, 1);
+  }
+  add_texels(hist, params->sky.texels,
+             (size_t)params->sky.width * params->sky.height, 31);
+  i = build_tables(params, hist);
+  free(hist);
+  if (i != 0)
+    return -1;
+  for (i = 0; i < WALL_TEXTURES; i++)
+    if (!(ix->walls[i] = quantize_texels(ix, &params->wall_textures[i])))
+      return -1;
+  ix->sky = quantize_texels(ix, &params->sky);
+  return ix->sky ? 0 : -1;
+}
+
+void indexed_free(t_params *params) {
+  t_indexed *ix = &params->indexed;
+  int i;
+
+  for (i = 0; i < WALL_TEXTURES; i++)
+    free(ix->walls[i]);
+  free(ix->sky);
+  free(ix->inverse);
+  free(ix->pixels);
+  ft_memset(ix, 0, sizeof(*ix));
+}
+
+// --- Drawing ---
+
+static void fill_column(t_params *params, int x, int y0, int y1,
+                        unsigned char index) {
+  unsigned char *dst;
+
+  y0 = (y0 < 0) ? 0 : y0;
+  y1 = (y1 >= WINDOW_HEIGHT) ? WINDOW_HEIGHT - 1 : y1;
+  dst = params->indexed.pixels + y0 * WINDOW_WIDTH + x;
+  COUNT_VIEW((y1 >= y0) ? y1 - y0 + 1 : 0, 0);
+  for (; y0 <= y1; y0++) {
+    *dst = index;
+    dst += WINDOW_WIDTH;
+  }
+}
+
+/**
+ * Indexed counterpart of draw_vertical_slice_direct: a flat column of
+ * base_color shaded for distance.
+ */
+void indexed_draw_fill(t_params *params, int x, int y0, int y1,
+                       int base_color, double distance) {
+  fill_column(params, x, y0, y1,
+              quantize(&params->indexed, apply_shading(base_color, distance)));
+}
+
+/**
+ * Indexed counterpart of draw_wall_column: ceiling (unless the sky is
+ * on), textured wall and floor of column x. Shading picks one remap row
+ * for the whole column.
+ */
+void indexed_draw_wall_column(t_params *params, int x,
+                              const t_wall_slice *s) {
+  t_texture *tex = &params->wall_textures[s->face];
+  int height = s->height;
+  int top = WINDOW_HEIGHT / 2 - height / 2;
+  int y0 = (top < 0) ? 0 : top;
+  int y1 = (top + height >= WINDOW_HEIGHT) ? WINDOW_HEIGHT - 1 : top + height;
+  int tex_x = (int)(s->u * tex->width), level;
+  const unsigned char *column, *remap;
+  unsigned int tex_pos, tex_step = s->tex_step;
+  unsigned char *dst;
+
+  if (!params->sky_enabled)
+    indexed_draw_fill(params, x, 0, top - 1, C_CEILING, MAX_VISIBLE_DISTANCE);
+  indexed_draw_fill(params, x, top + height + 1, WINDOW_HEIGHT - 1, C_FLOOR,
+                    MAX_VISIBLE_DISTANCE);
+  if (height <= 0)
+    return;
+  tex_x = (tex_x < 0) ? 0 : (tex_x >= tex->width ? tex->width - 1 : tex_x);
+  level = (int)(s->light * (1.0 - s->distance / MAX_VISIBLE_DISTANCE) *
+                    (PALETTE_LEVELS - 1) / 256.0 + 0.5);
+  level = (level < 0) ? 0 : (level >= PALETTE_LEVELS ? PALETTE_LEVELS - 1 : level);
+  remap = params->indexed.remap[level];
+  column = params->indexed.walls[s->face] + tex_x * tex->height;
+  tex_pos = (y0 - top) * tex_step;
+  dst = params->indexed.pixels + y0 * WINDOW_WIDTH + x;
+  COUNT_VIEW(y1 - y0 + 1, y1 - y0 + 1);
+  for (; y0 <= y1; y0++) {
+    *dst = remap[column[tex_pos >> 16]];
+    tex_pos += tex_step;
+    dst += WINDOW_WIDTH;
+  }
+}
+
+// Sky rows starting at panorama column first, as in draw_sky.
+void indexed_draw_sky(t_params *params, int first) {
+  t_texture *sky = &params->sky;
+  int run = sky->width - first, y;
+  int rows = (WINDOW_HEIGHT / 2 < sky->height) ? WINDOW_HEIGHT / 2 : sky->height;
+  unsigned char *dst;
+  const unsigned char *src;
+
+  if (run > WINDOW_WIDTH)
+    run = WINDOW_WIDTH;
+  COUNT_VIEW(rows * WINDOW_WIDTH, rows * WINDOW_WIDTH);
+  for (y = 0; y < rows; y++) {
+    dst = params->indexed.pixels + y * WINDOW_WIDTH;
+    src = params->indexed.sky + y * sky->width;
+    memcpy(dst, src + first, run);
+    if (run < WINDOW_WIDTH)
+      memcpy(dst + run, src, WINDOW_WIDTH - run);
+  }
+}
+
+// --- Expansion ---
+
+/**
+ * Expands the indexed view into window_img through the palette. SSE2 has
+ * no gather, so the lookups stay scalar; the pass writes 16 bytes at a
+ * time and is a single sequential read and write of the frame.
+ */
+void indexed_expand(t_params *params) {
+  const unsigned int *pal = params->indexed.palette;
+  const unsigned char *src = params->indexed.pixels;
+  t_img *img = &params->window_img;
+  unsigned int *dst;
+  int x, y;
+
+  for (y = 0; y < img->height; y++) {
+    dst = (unsigned int *)(img->addr + y * img->line_length);
+    x = 0;
+#ifdef __SSE2__
+    for (; x + 4 <= img->width; x += 4)
+      _mm_storeu_si128((__m128i *)(dst + x),
+                       _mm_setr_epi32((int)pal[src[x]], (int)pal[src[x + 1]],
+                                      (int)pal[src[x + 2]],
+                                      (int)pal[src[x + 3]]));
+#endif
+    for (; x < img->width; x++)
+      dst[x] = pal[src[x]];
+    src += WINDOW_WIDTH;
+  }
+}
@@ -0,0 +1,197 @@
+#include "../../include/cub3d.h"
+
+// --- Interlaced Rendering ---
+//
+// Casts and rasterizes every other column per frame and rebuilds the rest
+// from the previous frame. Rays are spaced by a constant angle, so turning
+// by delta moves the view by delta / step columns: column x now sees what
+// column x + shift saw last frame. Its hit is reused and its pixels are
+// copied from the history, rescaled vertically because the fisheye
+// correction makes wall height depend on the column's angle off centre.
+// Columns whose source is off screen or was itself reconstructed are
+// rendered. Reprojection only models rotation, so moving further than
+// INTERLACE_MAX_MOVE since the last frame forces a full one.
+
+static double column_offset(int x) {
+  return x * (PLAYER_FOV / NUM_RAYS) - PLAYER_FOV / 2.0;
+}
+
+static int rotation_shift(t_params *params) {
+  double delta = params->player.direction - params->interlace.prev_dir;
+
+  delta = normalize_angle(delta + M_PI) - M_PI;
+  return (int)lround(delta / (PLAYER_FOV / NUM_RAYS));
+}
+
+/**
+ * Marks the columns to render this frame. The rendered parity is picked
+ * so that the columns left out read from freshly rendered ones.
+ *
+ * @return true if the frame is partial, false if every column is rendered
+ */
+static bool build_mask(t_params *params, int shift) {
+  t_interlace *il = &params->interlace;
+  int x, src;
+
+  if (!il->valid || hypot(params->player.x - il->prev_x,
+                          params->player.y - il->prev_y) > INTERLACE_MAX_MOVE) {
+    memset(il->mask, 1, NUM_RAYS);
+    return false;
+  }
+  il->parity = (il->parity + shift + 1) & 1;
+  for (x = 0; x < NUM_RAYS; x++) {
+    src = x + shift;
+    il->mask[x] = (x & 1) == il->parity || src < 0 || src >= NUM_RAYS ||
+                  !il->prev_mask[src];
+  }
+  return true;
+}
+
+static void reproject_hits(t_params *params, t_ray_hit *ray_hits, int shift) {
+  t_interlace *il = &params->interlace;
+  double offset, scale;
+  int x;
+
+  for (x = 0; x < NUM_RAYS; x++) {
+    if (il->mask[x])
+      continue;
+    offset = column_offset(x);
+    scale = cos(offset) / cos(column_offset(x + shift));
+    ray_hits[x] = il->prev_hits[x + shift];
+    if (ray_hits[x].distance < MAX_VISIBLE_DISTANCE) {
+      ray_hits[x].distance *= scale;
+      // The height a full render draws here, read by first_row and the fog
+      ray_hits[x].height =
+          (int)(TILE_SIZE / ray_hits[x].distance * params->dist_proj_plane);
+    }
+    ray_hits[x].ray_angle = normalize_angle(params->player.direction + offset);
+  }
+}
+
+// First row to reconstruct after a turn: the sky above the wall is already
+// drawn and, being infinitely far, must not be rescaled like the wall.
+static int first_row(t_params *params, const t_ray_hit *hit) {
+  int height;
+
+  if (!params->sky_enabled)
+    return 0;
+  if (hit->distance >= MAX_VISIBLE_DISTANCE || hit->distance <= 0.01)
+    return params->window_img.height / 2;
+  height = hit->height;
+  return (height >= params->window_img.height)
+             ? 0
+             : params->window_img.height / 2 - height / 2;
+}
+
+/**
+ * Copies each reconstructed column from its history column, scaled about
+ * the horizon. Walks the screen row by row with a 16.16 source row per
+ * column: going down columns would touch a new page on every pixel of
+ * both images.
+ */
+static void reproject_pixels(t_params *params, t_ray_hit *ray_hits,
+                             int shift) {
+  t_interlace *il = &params->interlace;
+  t_img *img = &params->window_img;
+  int half = img->height / 2, n = 0, i, x, y, sy;
+  unsigned int *dst;
+
+  for (x = 0; x < NUM_RAYS; x++) {
+    if (il->mask[x])
+      continue;
+    il->cols[n] = x;
+    il->row_first[n] = shift ? first_row(params, &ray_hits[x]) : 0;
+    il->row_step[n] = lround(cos(column_offset(x)) /
+                             cos(column_offset(x + shift)) * 65536.0);
+    il->row_pos[n] = ((long)half << 16) - half * il->row_step[n] + 0x8000;
+    n++;
+  }
+  for (y = 0; y < img->height; y++) {
+    dst = (unsigned int *)(img->addr + y * img->line_length);
+    if (shift == 0) { // Every scale is 1: straight copy from the same row
+      for (i = 0; i < n; i++)
+        dst[il->cols[i]] = il->history[y * WINDOW_WIDTH + il->cols[i]];
+      continue;
+    }
+    for (i = 0; i < n; i++) {
+      if (y < il->row_first[i]) {
+        il->row_pos[i] += il->row_step[i];
+        continue;
+      }
+      sy = (int)(il->row_pos[i] >> 16);
+      if ((unsigned int)sy >= (unsigned int)img->height)
+        sy = (sy < 0) ? 0 : img->height - 1;
+      dst[il->cols[i]] = il->history[sy * WINDOW_WIDTH + il->cols[i] + shift];
+      il->row_pos[i] += il->row_step[i];
+    }
+  }
+}
+
+static void save_history(t_params *params, t_ray_hit *ray_hits) {
+  t_interlace *il = &params->interlace;
+  t_img *img = &params->window_img;
+  int y;
+
+  for (y = 0; y < img->height; y++)
+    memcpy(il->history + y * WINDOW_WIDTH, img->addr + y * img->line_length,
+           sizeof(*il->history) * WINDOW_WIDTH);
+  memcpy(il->prev_hits, ray_hits, sizeof(il->prev_hits));
+  memcpy(il->prev_mask, il->mask, sizeof(il->prev_mask));
+  il->prev_dir = params->player.direction;
+  il->prev_x = params->player.x;
+  il->prev_y = params->player.y;
+  il->valid = true;
+}
+
+/**
+ * Interlaced replacement for cast_rays + render_3d_view. Leaves a complete
+ * 3D view in window_img and all ray_hits filled, reconstructed columns
+ * included, so sprites, post-processing and the minimap run unchanged.
+ * Falls back to a full render if the history cannot be allocated.
+ */
+void interlace_render(t_params *params, t_ray_hit *ray_hits) {
+  t_interlace *il = &params->interlace;
+  bool partial;
+  int shift, x;
+
+  if (!il->history)
+    il->history = malloc(sizeof(*il->history) * WINDOW_WIDTH * WINDOW_HEIGHT);
+  if (!il->history || params->window_img.bpp != 4) {
+    cast_rays(params, ray_hits);
+    render_3d_view(params, ray_hits);
+    return;
+  }
+  shift = rotation_shift(params);
+  partial = build_mask(params, shift);
+  cast_rays_masked(params, ray_hits, il->mask);
+  if (partial)
+    reproject_hits(params, ray_hits, shift);
+  render_3d_view_masked(params, ray_hits, il->mask);
+  if (partial)
+    reproject_pixels(params, ray_hits, shift);
+  save_history(params, ray_hits);
+  il->stats.frames++;
+  il->stats.full_frames += !partial;
+  for (x = 0; x < NUM_RAYS; x++)
+    il->stats.cast_columns += il->mask[x];
+}
+
+// Forces the next interlaced frame to be rendered in full.
+void interlace_invalidate(t_params *params) {
+  params->interlace.valid = false;
+}
+
+// Frees the history and reports how many columns were actually rendered.
+void interlace_free(t_params *params) {
+  t_interlace_stats *s = &params->interlace.stats;
+
+  free(params->interlace.history);
+  params->interlace.history = NULL;
+  params->interlace.valid = false;
+  if (s->frames == 0)
+    return;
+  fprintf(stderr,
+          "interlace: %.1f%% of columns rendered, %lu of %lu frames full\n",
+          100.0 * s->cast_columns / ((double)s->frames * NUM_RAYS),
+          s->full_frames, s->frames);
+}
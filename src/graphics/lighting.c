@@ -0,0 +1,212 @@
+#include "../../include/cub3d.h"
+
+// --- Lightmap ---
+//
+// One light level per map cell, baked by a breadth-first flood from each
+// light so light bends around corners but never passes through solid
+// cells (they are lit, but stop the flood). Levels combine by max over
+// an ambient floor, which keeps updates local: when a cell or light
+// changes, only the cells within LIGHT_MAX_RADIUS are reset and the
+// lights that reach them re-flooded. Wall faces use the level of the
+// open cell in front of them, so the renderer pays one table lookup and
+// one multiply per column.
+
+typedef struct s_region {
+  int x0;
+  int y0;
+  int x1; // Inclusive
+  int y1; // Inclusive
+} t_region;
+
+static t_region region_around(t_params *params, int x, int y, int radius) {
+  t_region r;
+
+  r.x0 = (x - radius < 0) ? 0 : x - radius;
+  r.y0 = (y - radius < 0) ? 0 : y - radius;
+  r.x1 = (x + radius >= params->map.cols) ? params->map.cols - 1 : x + radius;
+  r.y1 = (y + radius >= params->map.rows) ? params->map.rows - 1 : y + radius;
+  return r;
+}
+
+static bool light_reaches(const t_light *l, const t_region *r) {
+  return l->x + l->radius >= r->x0 && l->x - l->radius <= r->x1 &&
+         l->y + l->radius >= r->y0 && l->y - l->radius <= r->y1;
+}
+
+// Quadratic falloff from intensity at the light down to ambient past radius.
+static unsigned char falloff(const t_light *l, int steps) {
+  int left = l->radius + 1 - steps;
+
+  if (l->intensity <= LIGHT_AMBIENT)
+    return LIGHT_AMBIENT;
+  return (unsigned char)(LIGHT_AMBIENT + (l->intensity - LIGHT_AMBIENT) *
+                                             left * left /
+                                             ((l->radius + 1) * (l->radius + 1)));
+}
+
+static void flood(t_params *params, const t_light *l, const t_region *r) {
+  static const int dx[4] = {1, -1, 0, 0};
+  static const int dy[4] = {0, 0, 1, -1};
+  t_lighting *lt = &params->lighting;
+  int cols = params->map.cols;
+  int head = 0, tail = 0, steps, end, cell, x, y, nx, ny, k;
+  unsigned char level;
+
+  if (cell_is_solid(params, l->x, l->y))
+    return;
+  lt->generation++;
+  lt->queue[tail++] = l->y * cols + l->x;
+  lt->visit[l->y * cols + l->x] = lt->generation;
+  for (steps = 0; head < tail && steps <= l->radius; steps++) {
+    level = falloff(l, steps);
+    for (end = tail; head < end; head++) {
+      cell = lt->queue[head];
+      x = cell % cols;
+      y = cell / cols;
+      if (x >= r->x0 && x <= r->x1 && y >= r->y0 && y <= r->y1 &&
+          level > lt->cells[cell])
+        lt->cells[cell] = level;
+      if (steps > 0 && cell_is_solid(params, x, y))
+        continue;
+      for (k = 0; k < 4; k++) {
+        nx = x + dx[k];
+        ny = y + dy[k];
+        if (nx < 0 || ny < 0 || nx >= cols || ny >= params->map.rows ||
+            lt->visit[ny * cols + nx] == lt->generation)
+          continue;
+        lt->visit[ny * cols + nx] = lt->generation;
+        lt->queue[tail++] = ny * cols + nx;
+      }
+    }
+  }
+}
+
+// Resets r to ambient and re-floods every light that reaches it.
+static void relight_region(t_params *params, const t_region *r) {
+  t_lighting *lt = &params->lighting;
+  int x, y, i;
+
+  if (!lt->cells)
+    return;
+  for (y = r->y0; y <= r->y1; y++)
+    for (x = r->x0; x <= r->x1; x++)
+      lt->cells[y * params->map.cols + x] = LIGHT_AMBIENT;
+  for (i = 0; i < lt->count; i++)
+    if (light_reaches(&lt->lights[i], r))
+      flood(params, &lt->lights[i], r);
+}
+
+/**
+ * Allocates the light grid, turns every lamp sprite into a light and
+ * bakes the whole map.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int lighting_init(t_params *params) {
+  t_lighting *lt = &params->lighting;
+  size_t cells = (size_t)params->map.rows * params->map.cols;
+  int i;
+
+  lt->cells = malloc(cells);
+  lt->queue = malloc(cells * sizeof(int));
+  lt->visit = calloc(cells, sizeof(int));
+  if (!lt->cells || !lt->queue || !lt->visit)
+    return -1;
+  ft_memset(lt->cells, LIGHT_AMBIENT, cells);
+  for (i = 0; i <= LIGHT_FULL; i++)
+    lt->lut[i] = (unsigned int)(256.0 * pow(i / (double)LIGHT_FULL, 0.6) + 0.5);
+  lt->enabled = true;
+  for (i = 0; i < params->sprites.count; i++)
+    if (params->sprites.items[i].texture == 0 &&
+        light_add(params, (int)(params->sprites.items[i].x / TILE_SIZE),
+                  (int)(params->sprites.items[i].y / TILE_SIZE),
+                  LIGHT_FULL, LIGHT_LAMP_RADIUS) < 0)
+      return -1;
+  return 0;
+}
+
+void lighting_free(t_params *params) {
+  t_lighting *lt = &params->lighting;
+
+  free(lt->cells);
+  free(lt->queue);
+  free(lt->visit);
+  free(lt->lights);
+  ft_memset(lt, 0, sizeof(*lt));
+}
+
+/**
+ * Adds a light in cell (x, y) reaching radius cells (at most
+ * LIGHT_MAX_RADIUS) and floods it into the grid.
+ *
+ * @return the light index, or -1 on allocation failure
+ */
+int light_add(t_params *params, int x, int y, int intensity, int radius) {
+  t_lighting *lt = &params->lighting;
+  t_light *lights;
+  t_region r;
+  int capacity;
+
+  if (lt->count == lt->capacity) {
+    capacity = lt->capacity ? lt->capacity * 2 : 8;
+    lights = realloc(lt->lights, capacity * sizeof(*lights));
+    if (!lights)
+      return -1;
+    lt->lights = lights;
+    lt->capacity = capacity;
+  }
+  if (radius > LIGHT_MAX_RADIUS)
+    radius = LIGHT_MAX_RADIUS;
+  lt->lights[lt->count] = (t_light){x, y, intensity, radius};
+  r = region_around(params, x, y, radius);
+  if (lt->cells)
+    flood(params, &lt->lights[lt->count], &r);
+  return lt->count++;
+}
+
+void light_remove(t_params *params, int index) {
+  t_lighting *lt = &params->lighting;
+  t_region r;
+
+  if (index < 0 || index >= lt->count)
+    return;
+  r = region_around(params, lt->lights[index].x, lt->lights[index].y,
+                    lt->lights[index].radius);
+  lt->lights[index] = lt->lights[--lt->count];
+  relight_region(params, &r);
+}
+
+// Called after cell (x, y) became more or less solid.
+void lighting_relight_cell(t_params *params, int x, int y) {
+  t_region r = region_around(params, x, y, LIGHT_MAX_RADIUS);
+
+  relight_region(params, &r);
+}
+
+/**
+ * Light level for a wall hit: the open cell in front of the face, or the
+ * door cell itself for door slabs. LIGHT_FULL when lighting is off.
+ */
+unsigned char lighting_sample_hit(t_params *params, const t_ray_hit *hit) {
+  int x = hit->map_x, y = hit->map_y;
+
+  if (!params->lighting.enabled || x < 0)
+    return LIGHT_FULL;
+  if (params->map.map_data[y][x] != DOOR) {
+    if (hit->is_vertical)
+      x -= (cos(hit->ray_angle) > 0) ? 1 : -1;
+    else
+      y -= (sin(hit->ray_angle) > 0) ? 1 : -1;
+  }
+  return params->lighting.cells[y * params->map.cols + x];
+}
+
+// Light level at a world position. LIGHT_FULL when lighting is off.
+unsigned char lighting_sample(t_params *params, double x, double y) {
+  int cx = (int)(x / TILE_SIZE), cy = (int)(y / TILE_SIZE);
+
+  if (!params->lighting.enabled || cx < 0 || cy < 0 ||
+      cx >= params->map.cols || cy >= params->map.rows)
+    return LIGHT_FULL;
+  return params->lighting.cells[cy * params->map.cols + cx];
+}
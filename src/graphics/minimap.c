@@ -0,0 +1,351 @@
+#include "../../include/cub3d.h"
+
+// --- Minimap ---
+//
+// A MINIMAP_SIZE square viewport that follows the player. Each zoom level
+// samples one level of the occupancy pyramid, either magnified (several
+// pixels per cell) or reduced (several cells per pixel), so the cost of a
+// frame depends on the viewport size and never on the map size. The
+// background is painted into a cached layer and copied with one memcpy
+// per row; only the player marker and rays are drawn per frame.
+
+#define C_MINIMAP_GRID C_BLACK
+#define C_MINIMAP_OUTSIDE C_BLACK
+#define MINIMAP_GRID_MIN_PX 5
+
+typedef struct s_minimap_zoom {
+  int level;    // Pyramid level: 2^level cells per texel
+  int texel_px; // Pixels per texel side
+} t_minimap_zoom;
+
+static const t_minimap_zoom g_minimap_zoom[] = {
+    {0, MAP_SCALE}, {0, 5}, {0, 2}, {0, 1}, {1, 1}, {2, 1}, {3, 1},
+    {4, 1},         {5, 1}};
+
+#define MINIMAP_ZOOM_COUNT                                                     \
+  (int)(sizeof(g_minimap_zoom) / sizeof(g_minimap_zoom[0]))
+
+static int floor_div(int a, int b) {
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static unsigned int density_color(unsigned char density) {
+  unsigned int g = 0x40 + (0x40 * density) / 255; // DARK_GRAY .. GRAY
+
+  return (g << 16) | (g << 8) | g;
+}
+
+// --- Occupancy Pyramid ---
+
+static void update_lod_texel(t_minimap *mm, int level, int x, int y) {
+  unsigned char *child = mm->lod[level - 1];
+  t_point cdim = mm->lod_dim[level - 1];
+  int sum = 0, count = 0, cx, cy;
+
+  for (cy = y * 2; cy < y * 2 + 2 && cy < cdim.y; cy++) {
+    for (cx = x * 2; cx < x * 2 + 2 && cx < cdim.x; cx++) {
+      sum += child[cy * cdim.x + cx];
+      count++;
+    }
+  }
+  mm->lod[level][y * mm->lod_dim[level].x + x] = sum / count;
+}
+
+static int build_pyramid(t_params *params) {
+  t_minimap *mm = &params->minimap;
+  t_point dim = {params->map.cols, params->map.rows};
+  int level, x, y;
+
+  for (level = 0; level < MINIMAP_LOD_LEVELS; level++) {
+    mm->lod_dim[level] = dim;
+    mm->lod[level] = malloc((size_t)dim.x * dim.y);
+    if (!mm->lod[level])
+      return -1;
+    mm->levels = level + 1;
+    for (y = 0; y < dim.y; y++) {
+      for (x = 0; x < dim.x; x++) {
+        if (level == 0)
+          mm->lod[0][y * dim.x + x] = cell_occupancy(params, x, y);
+        else
+          update_lod_texel(mm, level, x, y);
+      }
+    }
+    if (dim.x == 1 && dim.y == 1)
+      break;
+    dim.x = (dim.x + 1) / 2;
+    dim.y = (dim.y + 1) / 2;
+  }
+  return 0;
+}
+
+/**
+ * Builds the occupancy pyramid and allocates the viewport layer.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int minimap_init(t_params *params) {
+  t_minimap *mm = &params->minimap;
+
+  mm->layer_side = MINIMAP_SIZE + 2 * MINIMAP_LAYER_MARGIN;
+  mm->layer = malloc((size_t)mm->layer_side * mm->layer_side *
+                     sizeof(unsigned int));
+  if (!mm->layer)
+    return -1;
+  mm->layer_valid = false;
+  mm->dirty = false;
+  return build_pyramid(params);
+}
+
+void minimap_free(t_params *params) {
+  t_minimap *mm = &params->minimap;
+  int level;
+
+  for (level = 0; level < MINIMAP_LOD_LEVELS; level++) {
+    free(mm->lod[level]);
+    mm->lod[level] = NULL;
+  }
+  free(mm->layer);
+  mm->layer = NULL;
+}
+
+/**
+ * Refreshes the pyramid above map cell (x, y) and marks it for repaint.
+ * Costs one texel per pyramid level. Called by cell_set and doors_update
+ * with the world lock held, right after the cell changed.
+ */
+void minimap_invalidate_cell(t_params *params, int x, int y) {
+  t_minimap *mm = &params->minimap;
+  int level, lx = x, ly = y;
+
+  if (!mm->lod[0])
+    return;
+  mm->lod[0][y * mm->lod_dim[0].x + x] = cell_occupancy(params, x, y);
+  for (level = 1; level < mm->levels; level++) {
+    lx /= 2;
+    ly /= 2;
+    update_lod_texel(mm, level, lx, ly);
+  }
+  if (!mm->dirty) {
+    mm->dirty_min = (t_point){x, y};
+    mm->dirty_max = (t_point){x, y};
+    mm->dirty = true;
+    return;
+  }
+  if (x < mm->dirty_min.x)
+    mm->dirty_min.x = x;
+  if (y < mm->dirty_min.y)
+    mm->dirty_min.y = y;
+  if (x > mm->dirty_max.x)
+    mm->dirty_max.x = x;
+  if (y > mm->dirty_max.y)
+    mm->dirty_max.y = y;
+}
+
+/**
+ * Steps the zoom level; positive delta zooms out. Call with the world lock
+ * held.
+ */
+void minimap_zoom(t_params *params, int delta) {
+  t_minimap *mm = &params->minimap;
+  int zoom = mm->zoom + delta;
+
+  if (zoom < 0)
+    zoom = 0;
+  while (zoom >= MINIMAP_ZOOM_COUNT ||
+         (zoom > 0 && g_minimap_zoom[zoom].level >= mm->levels))
+    zoom--;
+  mm->zoom = zoom;
+}
+
+/**
+ * Converts world coordinates to minimap pixels for the current frame.
+ * Only valid after draw_map has positioned the view.
+ */
+t_point minimap_world_to_px(t_params *params, double x, double y) {
+  t_minimap *mm = &params->minimap;
+
+  return (t_point){(int)floor(x * mm->scale) - mm->view_origin.x,
+                   (int)floor(y * mm->scale) - mm->view_origin.y};
+}
+
+// --- Layer Painting ---
+
+/**
+ * Repaints layer pixels [x0, x1) x [y0, y1) from the pyramid, filling one
+ * run per texel.
+ */
+static void paint_layer(t_minimap *mm, int x0, int y0, int x1, int y1) {
+  t_minimap_zoom z = g_minimap_zoom[mm->layer_zoom];
+  t_point dim = mm->lod_dim[z.level];
+  int t = z.texel_px;
+  bool grid = (t >= MINIMAP_GRID_MIN_PX);
+  unsigned char *lod_row;
+  unsigned int *row, color;
+  int px, py, gy, ty, tx, last, run_end, i;
+  bool gap_row, inside;
+
+  for (py = y0; py < y1; py++) {
+    gy = mm->layer_origin.y + py;
+    ty = floor_div(gy, t);
+    gap_row = grid && (gy - ty * t == t - 1);
+    lod_row = (ty >= 0 && ty < dim.y) ? mm->lod[z.level] + ty * dim.x : NULL;
+    row = mm->layer + (size_t)py * mm->layer_side;
+    px = x0;
+    while (px < x1) {
+      tx = floor_div(mm->layer_origin.x + px, t);
+      last = (tx + 1) * t - mm->layer_origin.x - 1; // Last pixel of texel
+      run_end = (last < x1) ? last + 1 : x1;
+      inside = lod_row && tx >= 0 && tx < dim.x;
+      if (!inside)
+        color = C_MINIMAP_OUTSIDE;
+      else if (gap_row)
+        color = C_MINIMAP_GRID;
+      else
+        color = density_color(lod_row[tx]);
+      for (i = px; i < run_end; i++)
+        row[i] = color;
+      if (inside && grid && last < x1)
+        row[last] = C_MINIMAP_GRID;
+      px = run_end;
+    }
+  }
+}
+
+/**
+ * Repaints the part of the layer covered by the dirty cell rectangle.
+ */
+static void repaint_dirty(t_minimap *mm) {
+  t_minimap_zoom z = g_minimap_zoom[mm->layer_zoom];
+  int t = z.texel_px;
+  int x0 = (mm->dirty_min.x >> z.level) * t - mm->layer_origin.x;
+  int y0 = (mm->dirty_min.y >> z.level) * t - mm->layer_origin.y;
+  int x1 = ((mm->dirty_max.x >> z.level) + 1) * t - mm->layer_origin.x;
+  int y1 = ((mm->dirty_max.y >> z.level) + 1) * t - mm->layer_origin.y;
+
+  x0 = (x0 < 0) ? 0 : x0;
+  y0 = (y0 < 0) ? 0 : y0;
+  x1 = (x1 > mm->layer_side) ? mm->layer_side : x1;
+  y1 = (y1 > mm->layer_side) ? mm->layer_side : y1;
+  if (x0 < x1 && y0 < y1)
+    paint_layer(mm, x0, y0, x1, y1);
+}
+
+/**
+ * Makes sure the cached layer covers the current view, repainting it
+ * entirely when the view left the margin or the zoom changed.
+ */
+static void update_layer(t_minimap *mm) {
+  int t = g_minimap_zoom[mm->zoom].texel_px;
+  t_point v = mm->view_origin;
+  int side = mm->layer_side;
+
+  if (mm->layer_valid && mm->layer_zoom == mm->zoom &&
+      v.x >= mm->layer_origin.x && v.y >= mm->layer_origin.y &&
+      v.x + MINIMAP_SIZE <= mm->layer_origin.x + side &&
+      v.y + MINIMAP_SIZE <= mm->layer_origin.y + side) {
+    if (mm->dirty)
+      repaint_dirty(mm);
+    mm->dirty = false;
+    return;
+  }
+  mm->layer_zoom = mm->zoom;
+  mm->layer_origin.x = floor_div(v.x - MINIMAP_LAYER_MARGIN, t) * t;
+  mm->layer_origin.y = floor_div(v.y - MINIMAP_LAYER_MARGIN, t) * t;
+  paint_layer(mm, 0, 0, side, side);
+  mm->layer_valid = true;
+  mm->dirty = false;
+}
+
+void draw_map(t_params *params) {
+  t_minimap *mm = &params->minimap;
+  t_minimap_zoom z = g_minimap_zoom[mm->zoom];
+  t_img *img = &params->window_img;
+  unsigned int *src;
+  int x, y, size_x, size_y;
+
+  if (!mm->layer)
+    return;
+  mm->scale = (double)z.texel_px / (TILE_SIZE * (double)(1 << z.level));
+  mm->view_origin.x =
+      (int)floor(params->player.x * mm->scale) - MINIMAP_SIZE / 2;
+  mm->view_origin.y =
+      (int)floor(params->player.y * mm->scale) - MINIMAP_SIZE / 2;
+  update_layer(mm);
+
+  size_x = (MINIMAP_SIZE < img->width) ? MINIMAP_SIZE : img->width;
+  size_y = (MINIMAP_SIZE < img->height) ? MINIMAP_SIZE : img->height;
+  src = mm->layer +
+        (size_t)(mm->view_origin.y - mm->layer_origin.y) * mm->layer_side +
+        (mm->view_origin.x - mm->layer_origin.x);
+  COUNT_MINIMAP(size_x * size_y);
+  for (y = 0; y < size_y; y++) {
+    if (img->bpp == 4)
+      memcpy(img->addr + y * img->line_length, src,
+             size_x * sizeof(unsigned int));
+    else
+      for (x = 0; x < size_x; x++)
+        put_pixel_direct(img, x, y, src[x]);
+    src += mm->layer_side;
+  }
+}
+
+void draw_player(t_params *params) {
+  int player_marker_size = 4;
+  t_point center = minimap_world_to_px(params, params->player.x,
+                                       params->player.y);
+  int i, j;
+
+  for (i = -player_marker_size / 2; i <= player_marker_size / 2; i++) {
+    for (j = -player_marker_size / 2; j <= player_marker_size / 2; j++) {
+      put_pixel_direct(&params->window_img, center.x + i, center.y + j, C_RED);
+      COUNT_MINIMAP(1);
+    }
+  }
+
+  t_point p2 = {
+      center.x + (int)(cos(params->player.direction) * MAP_SCALE * 1.5),
+      center.y + (int)(sin(params->player.direction) * MAP_SCALE * 1.5)};
+  draw_line_img(params, center, p2, C_RED);
+}
+
+static t_fpoint ray_end_px(t_params *params, t_ray_hit *hit) {
+  t_minimap *mm = &params->minimap;
+  double x = hit->hit_point.x, y = hit->hit_point.y;
+
+  if (hit->map_x < 0) { // No wall hit: stop at the visibility limit
+    x = params->player.x + cos(hit->ray_angle) * MAX_VISIBLE_DISTANCE;
+    y = params->player.y + sin(hit->ray_angle) * MAX_VISIBLE_DISTANCE;
+  }
+  return (t_fpoint){x * mm->scale - mm->view_origin.x,
+                    y * mm->scale - mm->view_origin.y};
+}
+
+/**
+ * Shades the visible area as one translucent polygon: a triangle fan from
+ * the player through every MINIMAP_RAY_STEP-th ray end point.
+ */
+void draw_rays_minimap(t_params *params, t_ray_hit *ray_hits) {
+  static t_fpoint rim[NUM_RAYS / MINIMAP_RAY_STEP + 2];
+  t_minimap *mm = &params->minimap;
+  t_fan fan;
+  int i, count = 0;
+
+  for (i = 0; i < NUM_RAYS; i += MINIMAP_RAY_STEP)
+    rim[count++] = ray_end_px(params, &ray_hits[i]);
+  if ((NUM_RAYS - 1) % MINIMAP_RAY_STEP != 0)
+    rim[count++] = ray_end_px(params, &ray_hits[NUM_RAYS - 1]);
+
+  fan.center = (t_fpoint){params->player.x * mm->scale - mm->view_origin.x,
+                          params->player.y * mm->scale - mm->view_origin.y};
+  fan.rim = rim;
+  fan.count = count;
+  fan.color = C_YELLOW;
+  fan.alpha = MINIMAP_FAN_ALPHA;
+  fan.clip_w = (MINIMAP_SIZE < params->window_img.width)
+                   ? MINIMAP_SIZE
+                   : params->window_img.width;
+  fan.clip_h = (MINIMAP_SIZE < params->window_img.height)
+                   ? MINIMAP_SIZE
+                   : params->window_img.height;
+  fill_triangle_fan(&params->window_img, &fan);
+}
@@ -0,0 +1,234 @@
+#include "../../include/cub3d.h"
+#ifdef __SSE2__
+# include <emmintrin.h>
+# define POST_SIMD 1
+#else
+# define POST_SIMD 0
+#endif
+
+// --- Post-Processing ---
+//
+// Fog, vignette and gamma run as one row-major sweep over the 3D view, so
+// the framebuffer is read and written once no matter how many stages are
+// on. Every stage is reduced to small per-row and per-column tables
+// rebuilt each frame:
+//  - fog keeps keep/256 of the pixel and blends in FOG_COLOR. Depth comes
+//    from the column's wall distance inside the rows its wall was drawn
+//    on and from the floor/ceiling distance of the row elsewhere;
+//  - the vignette is separable: vig_x[x] * vig_y[y];
+//  - gamma is a per-channel LUT.
+// Fog and vignette are 8.8 fixed-point multiplies done four pixels at a
+// time with SSE2 where available; gamma is a byte lookup in the same loop.
+// The sweep runs before sprites: a sprite's depth is not in these tables,
+// so draw_sprite_column applies the stages to its pixels itself.
+
+// Share of a pixel at depth left by fog, out of 256.
+int post_fog_keep(double depth) {
+  double t = (depth - FOG_START) / (MAX_VISIBLE_DISTANCE - FOG_START);
+
+  if (t <= 0.0)
+    return 256;
+  if (t >= 1.0)
+    return 0;
+  return (int)(256.0 * (1.0 - t));
+}
+
+static int vignette(int i, int size) {
+  double d = (i + 0.5 - size / 2.0) / (size / 2.0);
+
+  return (int)(256.0 * (1.0 - VIGNETTE_STRENGTH * d * d));
+}
+
+// Builds the tables that depend only on the flags and the camera.
+static void build_static_tables(t_params *params) {
+  t_post *pp = &params->post;
+  double half = WINDOW_HEIGHT / 2.0;
+  int i;
+
+  for (i = 0; i < WINDOW_HEIGHT; i++) {
+    pp->row_keep[i] = (pp->flags & POST_FOG)
+                          ? post_fog_keep(TILE_SIZE / 2.0 * params->dist_proj_plane /
+                                     (fabs(i + 0.5 - half)))
+                          : 256;
+    pp->vig_y[i] =
+        (pp->flags & POST_VIGNETTE) ? vignette(i, WINDOW_HEIGHT) : 256;
+  }
+  for (i = 0; i < WINDOW_WIDTH; i++)
+    pp->vig_x[i] = (pp->flags & POST_VIGNETTE) ? vignette(i, WINDOW_WIDTH) : 256;
+  for (i = 0; i < 256; i++)
+    pp->gamma[i] =
+        (unsigned char)(255.0 * pow(i / 255.0, 1.0 / POST_GAMMA_CURVE) + 0.5);
+  pp->built_flags = pp->flags;
+  pp->built_plane = params->dist_proj_plane;
+}
+
+// Wall span and fog per column, from the heights render_3d_view drew.
+static void build_column_tables(t_params *params, t_ray_hit *ray_hits) {
+  t_post *pp = &params->post;
+  int x;
+
+  for (x = 0; x < NUM_RAYS; x++) {
+    pp->top[x] = 0;
+    pp->bottom[x] = 0;
+    pp->col_keep[x] = 256;
+    if (!(pp->flags & POST_FOG) || ray_hits[x].distance >= MAX_VISIBLE_DISTANCE ||
+        ray_hits[x].distance <= 0.01)
+      continue;
+    pp->top[x] = WINDOW_HEIGHT / 2 - ray_hits[x].height / 2;
+    pp->bottom[x] = pp->top[x] + ray_hits[x].height + 1;
+    pp->col_keep[x] = post_fog_keep(ray_hits[x].distance);
+  }
+}
+
+// Red and blue share one multiply, as in shade_color.
+static inline unsigned int blend_pixel(unsigned int c, unsigned int keep,
+                                       unsigned int vig, unsigned int fog) {
+  unsigned int rb, g;
+
+  rb = (((c & 0xFF00FF) * keep + (fog & 0xFF00FF) * (256 - keep)) >> 8) &
+       0xFF00FF;
+  g = (((c & 0x00FF00) * keep + (fog & 0x00FF00) * (256 - keep)) >> 8) &
+      0x00FF00;
+  return (((rb * vig) >> 8) & 0xFF00FF) | (((g * vig) >> 8) & 0x00FF00);
+}
+
+static void sweep_row_scalar(const t_post *pp, unsigned int *px, int y,
+                             int x0) {
+  int x, keep;
+
+  for (x = x0; x < WINDOW_WIDTH; x++) {
+    keep = (y >= pp->top[x] && y < pp->bottom[x]) ? pp->col_keep[x]
+                                                   : pp->row_keep[y];
+    px[x] = blend_pixel(px[x], keep, (pp->vig_x[x] * pp->vig_y[y]) >> 8,
+                        FOG_COLOR);
+  }
+}
+
+#ifdef __SSE2__
+// Spreads four 32-bit factors over the channels of two pixel pairs.
+static inline void spread(__m128i f, __m128i *lo, __m128i *hi) {
+  f = _mm_packs_epi32(f, f);
+  f = _mm_unpacklo_epi16(f, f);
+  *lo = _mm_unpacklo_epi32(f, f);
+  *hi = _mm_unpackhi_epi32(f, f);
+}
+
+static inline __m128i blend_pair(__m128i c, __m128i keep, __m128i vig,
+                                 __m128i fog) {
+  __m128i inv = _mm_sub_epi16(_mm_set1_epi16(256), keep);
+
+  c = _mm_add_epi16(_mm_mullo_epi16(c, keep), _mm_mullo_epi16(fog, inv));
+  c = _mm_srli_epi16(c, 8);
+  return _mm_srli_epi16(_mm_mullo_epi16(c, vig), 8);
+}
+
+// Fog and vignette for four pixels per step; returns the first x left.
+static int sweep_row_sse2(const t_post *pp, unsigned int *px, int y) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i fog = _mm_unpacklo_epi8(_mm_set1_epi32(FOG_COLOR), zero);
+  const __m128i yv = _mm_set1_epi32(y);
+  const __m128i row_keep = _mm_set1_epi32(pp->row_keep[y]);
+  const __m128i vig_y = _mm_set1_epi32(pp->vig_y[y]);
+  __m128i c, in, keep, vig, k_lo, k_hi, v_lo, v_hi;
+  int x;
+
+  for (x = 0; x + 4 <= WINDOW_WIDTH; x += 4) {
+    in = _mm_andnot_si128(
+        _mm_cmplt_epi32(yv, _mm_loadu_si128((const __m128i *)&pp->top[x])),
+        _mm_cmplt_epi32(yv, _mm_loadu_si128((const __m128i *)&pp->bottom[x])));
+    keep = _mm_or_si128(
+        _mm_and_si128(in, _mm_loadu_si128((const __m128i *)&pp->col_keep[x])),
+        _mm_andnot_si128(in, row_keep));
+    vig = _mm_srli_epi32(
+        _mm_madd_epi16(_mm_loadu_si128((const __m128i *)&pp->vig_x[x]), vig_y),
+        8);
+    spread(keep, &k_lo, &k_hi);
+    spread(vig, &v_lo, &v_hi);
+    c = _mm_loadu_si128((const __m128i *)&px[x]);
+    c = _mm_packus_epi16(
+        blend_pair(_mm_unpacklo_epi8(c, zero), k_lo, v_lo, fog),
+        blend_pair(_mm_unpackhi_epi8(c, zero), k_hi, v_hi, fog));
+    _mm_storeu_si128((__m128i *)&px[x], c);
+  }
+  return x;
+}
+#endif
+
+static void sweep(t_post *pp, t_img *img, unsigned int flags) {
+  const unsigned char *gm = pp->gamma;
+  unsigned int *px, c;
+  int y, x;
+
+  for (y = 0; y < WINDOW_HEIGHT; y++) {
+    px = (unsigned int *)(img->addr + y * img->line_length);
+    if (flags & (POST_FOG | POST_VIGNETTE)) {
+      x = 0;
+#ifdef __SSE2__
+      x = sweep_row_sse2(pp, px, y);
+#endif
+      sweep_row_scalar(pp, px, y, x);
+    }
+    if (!(flags & POST_GAMMA))
+      continue;
+    for (x = 0; x < WINDOW_WIDTH; x++) {
+      c = px[x];
+      px[x] = (unsigned int)gm[(c >> 16) & 0xFF] << 16 |
+              (unsigned int)gm[(c >> 8) & 0xFF] << 8 | gm[c & 0xFF];
+    }
+  }
+}
+
+/**
+ * Applies the enabled post-processing stages to the 3D view in
+ * params->window_img. Runs after the walls and before sprites.
+ */
+void post_process(t_params *params, t_ray_hit *ray_hits) {
+  t_post *pp = &params->post;
+  t_img *img = &params->window_img;
+
+  if (!(pp->flags & POST_ALL) || img->bpp != 4 || img->width != WINDOW_WIDTH ||
+      img->height != WINDOW_HEIGHT)
+    return;
+  if (pp->flags != pp->built_flags ||
+      params->dist_proj_plane != pp->built_plane)
+    build_static_tables(params);
+  build_column_tables(params, ray_hits);
+  sweep(pp, img, pp->flags);
+}
+
+/**
+ * Times the sweep on a scratch copy of the current frame with each stage
+ * alone and with all of them fused, and prints the cost per frame. Fog
+ * and vignette share one arithmetic pass, so either alone costs about
+ * the same as both. Reuses the column tables of the last post_process.
+ */
+void post_report_costs(t_params *params, FILE *out) {
+  static const unsigned int stages[] = {POST_FOG, POST_VIGNETTE, POST_GAMMA,
+                                        POST_ALL};
+  static const char *names[] = {"fog", "vignette", "gamma", "fused"};
+  t_post *pp = &params->post;
+  unsigned int saved = pp->flags;
+  t_img scratch = params->window_img;
+  size_t size = (size_t)scratch.line_length * scratch.height;
+  long start;
+  int s, i;
+
+  if (scratch.bpp != 4 || scratch.width != WINDOW_WIDTH ||
+      scratch.height != WINDOW_HEIGHT || !(scratch.addr = malloc(size)))
+    return;
+  memcpy(scratch.addr, params->window_img.addr, size);
+  fprintf(out, "post-process (%s):", POST_SIMD ? "sse2" : "scalar");
+  for (s = 0; s < 4; s++) {
+    pp->flags = stages[s];
+    build_static_tables(params);
+    start = get_time_us();
+    for (i = 0; i < POST_CALIBRATION_RUNS; i++)
+      sweep(pp, &scratch, stages[s]);
+    fprintf(out, " %s %.3f ms%s", names[s],
+            (get_time_us() - start) / 1000.0 / POST_CALIBRATION_RUNS,
+            s < 3 ? "," : "\n");
+  }
+  pp->flags = saved;
+  build_static_tables(params);
+  free(scratch.addr);
+}
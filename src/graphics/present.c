@@ -0,0 +1,302 @@
+#include "../../include/cub3d.h"
+
+// --- Render / Present Pipeline ---
+//
+// The render thread rasterizes into a ring of PRESENT_BUFFERS images while
+// the main thread (the only one that talks to X) uploads finished frames.
+// A buffer handed to mlx_put_image_to_window is only recycled on the next
+// game_loop call: mlx_loop runs XSync between loop hooks, so by then the
+// server is done reading the shared memory.
+//
+// At most one finished frame waits: a newer one replaces it (counted as
+// dropped). The render thread starts each frame just in time for the
+// present tick after the one that takes the waiting frame, using the
+// average render time plus PRESENT_MARGIN_US, so frames are drawn as late
+// as possible. When rendering takes longer than the tick period, the start
+// time is already past and the thread draws continuously. Three buffers
+// let it draw the next frame while one frame is shown and another waits.
+// With two, it must wait for the shown frame to be recycled, and the
+// frame rate drops to whole ticks per frame.
+
+static int new_frame_image(t_params *params, t_img *img) {
+  img->width = WINDOW_WIDTH;
+  img->height = WINDOW_HEIGHT;
+  img->img = mlx_new_image(params->mlx, img->width, img->height);
+  if (!img->img)
+    return -1;
+  img->addr = mlx_get_data_addr(img->img, &img->bits_per_pixel,
+                                &img->line_length, &img->endian);
+  if (!img->addr)
+    return -1;
+  img->bpp = img->bits_per_pixel / 8;
+  return 0;
+}
+
+void world_lock(t_params *params) {
+#ifdef PRESENT_THREAD
+  pthread_mutex_lock(&params->present.world_lock);
+#else
+  (void)params;
+#endif
+}
+
+void world_unlock(t_params *params) {
+#ifdef PRESENT_THREAD
+  pthread_mutex_unlock(&params->present.world_lock);
+#else
+  (void)params;
+#endif
+}
+
+/**
+ * Waits for the render thread to finish its frame and keeps it from
+ * starting another until render_resume, so a report can read the
+ * renderer's state. Only the main thread may call this.
+ */
+void render_pause(t_params *params) {
+  if (params->present.started)
+    pthread_mutex_lock(&params->present.frame_lock);
+}
+
+void render_resume(t_params *params) {
+  if (params->present.started)
+    pthread_mutex_unlock(&params->present.frame_lock);
+}
+
+/**
+ * Sets up the framebuffer ring. Slot 0 adopts the already created
+ * window_img so the single-threaded path and cleanup keep working unchanged.
+ *
+ * @return 0 on success, -1 if an image could not be created
+ */
+int present_init(t_params *params) {
+  t_present *p = &params->present;
+  pthread_condattr_t attr;
+  int i, status;
+
+  p->presenting = -1;
+  p->buffers[0].img = params->window_img;
+  for (i = 1; i < PRESENT_BUFFERS; i++) {
+    if (new_frame_image(params, &p->buffers[i].img) != 0)
+      return -1;
+  }
+  for (i = 0; i < PRESENT_BUFFERS; i++)
+    p->buffers[i].state = BUF_FREE;
+  if (pthread_mutex_init(&p->world_lock, NULL) != 0 ||
+      pthread_mutex_init(&p->frame_lock, NULL) != 0 ||
+      pthread_mutex_init(&p->swap_lock, NULL) != 0 ||
+      pthread_condattr_init(&attr) != 0)
+    return -1;
+  status = (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+            pthread_cond_init(&p->swap_cond, &attr) == 0)
+               ? 0
+               : -1;
+  pthread_condattr_destroy(&attr);
+  return status;
+}
+
+static int find_buffer(t_present *p, t_buffer_state state) {
+  int i, best = -1;
+
+  for (i = 0; i < PRESENT_BUFFERS; i++) {
+    if (p->buffers[i].state != state)
+      continue;
+    if (best < 0 || p->buffers[i].seq < p->buffers[best].seq)
+      best = i;
+  }
+  return best;
+}
+
+/**
+ * When the render thread should start its next frame, from the present
+ * ticks seen so far. 0 means at once. Call with swap_lock held.
+ */
+static long frame_start_us(t_present *p) {
+  const long period = (FRAME_RATE_CAP > 0) ? 1000000L / FRAME_RATE_CAP : 0;
+
+  const long lead = p->render_est_us + 4 * p->render_dev_us + PRESENT_MARGIN_US;
+  long tick;
+
+  if (p->last_tick_us == 0 || lead >= period) // Can't keep up: no idling
+    return 0;
+  tick = p->last_tick_us + period;
+  if (find_buffer(p, BUF_READY) >= 0) // It goes out at the next tick
+    tick += period;
+  return tick - lead;
+}
+
+static void wait_until(t_present *p, long when_us) {
+  struct timespec ts;
+
+  ts.tv_sec = when_us / 1000000L;
+  ts.tv_nsec = when_us % 1000000L * 1000L;
+  pthread_cond_timedwait(&p->swap_cond, &p->swap_lock, &ts);
+}
+
+static void *render_thread_main(void *arg) {
+  static t_ray_hit ray_hits[NUM_RAYS]; // Owned by this thread only
+  t_params *params = arg;
+  t_present *p = &params->present;
+  t_frame_buffer *buf;
+  long wait_start, sync_start, start_us, took;
+  int idx, old;
+
+  PROF_THREAD("render");
+  while (1) {
+    wait_start = get_time_us();
+    pthread_mutex_lock(&p->swap_lock);
+    while (p->running) {
+      idx = find_buffer(p, BUF_FREE);
+      start_us = frame_start_us(p);
+      if (idx < 0)
+        pthread_cond_wait(&p->swap_cond, &p->swap_lock);
+      else if (start_us > get_time_us())
+        wait_until(p, start_us);
+      else
+        break;
+    }
+    if (!p->running) {
+      pthread_mutex_unlock(&p->swap_lock);
+      break;
+    }
+    buf = &p->buffers[idx];
+    buf->state = BUF_RENDERING;
+    buf->seq = p->next_seq++;
+    pthread_mutex_unlock(&p->swap_lock);
+
+    sync_start = get_time_us();
+    pthread_mutex_lock(&p->world_lock); // Held only to copy the world
+    view_sync(p->view, params, sim_clock(params));
+    pthread_mutex_unlock(&p->world_lock);
+    pthread_mutex_lock(&p->frame_lock);
+    buf->render_start_us = get_time_us();
+    p->view->window_img = buf->img;
+    render_frame(p->view, ray_hits);
+    buf->render_end_us = get_time_us();
+    pthread_mutex_unlock(&p->frame_lock);
+
+    pthread_mutex_lock(&p->swap_lock);
+    old = find_buffer(p, BUF_READY);
+    if (old >= 0) { // Superseded before it could be shown
+      p->buffers[old].state = BUF_FREE;
+      p->stats.frames_dropped++;
+    }
+    buf->state = BUF_READY;
+    took = buf->render_end_us - buf->render_start_us;
+    p->render_dev_us += (labs(took - p->render_est_us) - p->render_dev_us) / 4;
+    p->render_est_us += (took - p->render_est_us) / 8;
+    p->stats.frames_rendered++;
+    p->stats.render_us_total += buf->render_end_us - buf->render_start_us;
+    p->stats.render_wait_us_total += sync_start - wait_start;
+    p->stats.sync_us_total += buf->render_start_us - sync_start;
+    pthread_cond_broadcast(&p->swap_cond);
+    pthread_mutex_unlock(&p->swap_lock);
+  }
+  return NULL;
+}
+
+int present_start(t_params *params) {
+  t_present *p = &params->present;
+
+  p->view = view_new(params);
+  if (!p->view)
+    return -1;
+  p->running = true;
+  p->stats.started_us = get_time_us();
+  if (pthread_create(&p->thread, NULL, render_thread_main, params) != 0) {
+    p->running = false;
+    view_free(p->view, params);
+    p->view = NULL;
+    return -1;
+  }
+  p->started = true;
+  return 0;
+}
+
+/**
+ * Main-thread half of the handoff, called once per mlx loop iteration.
+ * Recycles the buffer shown last time and uploads the oldest finished
+ * frame, if any. Never waits for the render thread.
+ */
+void present_frame(t_params *params) {
+  t_present *p = &params->present;
+  t_frame_buffer *buf;
+  long latency;
+  int idx;
+
+  pthread_mutex_lock(&p->swap_lock);
+  p->last_tick_us = get_time_us();
+  if (p->presenting >= 0) {
+    buf = &p->buffers[p->presenting];
+    latency = get_time_us() - buf->render_start_us;
+    p->stats.latency_us_total += latency;
+    if (latency > p->stats.latency_us_max)
+      p->stats.latency_us_max = latency;
+    buf->state = BUF_FREE;
+    p->presenting = -1;
+  }
+  idx = find_buffer(p, BUF_READY);
+  if (idx < 0) {
+    p->stats.present_starved++;
+    pthread_cond_broadcast(&p->swap_cond); // The tick moves the start time
+    pthread_mutex_unlock(&p->swap_lock);
+    return;
+  }
+  p->buffers[idx].state = BUF_PRESENTING;
+  p->presenting = idx;
+  p->stats.frames_presented++;
+  pthread_cond_broadcast(&p->swap_cond); // The render thread may go on
+  pthread_mutex_unlock(&p->swap_lock);
+  mlx_put_image_to_window(params->mlx, params->win, p->buffers[idx].img.img, 0,
+                          0);
+}
+
+static void print_present_stats(t_present *p) {
+  t_present_stats *s = &p->stats;
+  double secs = (get_time_us() - s->started_us) / 1e6;
+  unsigned long shown = s->frames_presented;
+
+  if (secs <= 0.0 || s->frames_rendered == 0)
+    return;
+  fprintf(stderr,
+          "present: %d buffers, %.1f fps rendered, %.1f fps presented, "
+          "render %.2f ms avg, render idle %.2f ms/frame, "
+          "world copy %.3f ms/frame, "
+          "latency %.2f ms avg / %.2f ms max, %lu starved presents, "
+          "%lu dropped frames\n",
+          PRESENT_BUFFERS, s->frames_rendered / secs, shown / secs,
+          s->render_us_total / 1000.0 / s->frames_rendered,
+          s->render_wait_us_total / 1000.0 / s->frames_rendered,
+          s->sync_us_total / 1000.0 / s->frames_rendered,
+          shown > 1 ? s->latency_us_total / 1000.0 / (shown - 1) : 0.0,
+          s->latency_us_max / 1000.0, s->present_starved, s->frames_dropped);
+}
+
+/**
+ * Stops and joins the render thread, reports pipeline statistics and
+ * releases the extra buffers. Slot 0 is handed back to window_img so
+ * cleanup destroys it exactly once. Must not be called with world_lock held.
+ */
+void present_shutdown(t_params *params) {
+  t_present *p = &params->present;
+  int i;
+
+  if (p->started) {
+    pthread_mutex_lock(&p->swap_lock);
+    p->running = false;
+    pthread_cond_broadcast(&p->swap_cond);
+    pthread_mutex_unlock(&p->swap_lock);
+    pthread_join(p->thread, NULL);
+    p->started = false;
+    print_present_stats(p);
+  }
+  view_free(p->view, params); // Hands the renderer's state back for cleanup
+  p->view = NULL;
+  for (i = 1; i < PRESENT_BUFFERS; i++) {
+    if (p->buffers[i].img.img)
+      mlx_destroy_image(params->mlx, p->buffers[i].img.img);
+    p->buffers[i].img.img = NULL;
+  }
+  if (p->buffers[0].img.img)
+    params->window_img = p->buffers[0].img;
+}
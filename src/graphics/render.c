@@ -0,0 +1,501 @@
+#include "../../include/cub3d.h"
+
+// --- Optimized Drawing & Helpers ---
+
+void clear_image_direct(t_params *params, int color) {
+  int y;
+  char *line_start;
+  int pixel_bytes = params->window_img.bpp;
+
+  if (pixel_bytes == 4) {
+    line_start = params->window_img.addr;
+    for (y = 0; y < params->window_img.height; y++) {
+      for (int x = 0; x < params->window_img.width; ++x) {
+        *(unsigned int *)(line_start + x * pixel_bytes) = color;
+      }
+      line_start += params->window_img.line_length;
+    }
+  } else // Fallback for other BPP
+  {
+    for (y = 0; y < params->window_img.height; y++) {
+      for (int x = 0; x < params->window_img.width; x++) {
+        put_pixel_direct(&params->window_img, x, y, color);
+      }
+    }
+  }
+}
+
+double normalize_angle(double angle) {
+  angle = fmod(angle, 2.0 * M_PI);
+  if (angle < 0)
+    angle += (2.0 * M_PI);
+  return angle;
+}
+
+int apply_shading(int color, double distance) {
+  double brightness;
+  int r, g, b;
+
+  if (distance <= 0)
+    return color;
+
+  brightness = 1.0 - (distance / MAX_VISIBLE_DISTANCE);
+  if (brightness < 0.0)
+    brightness = 0.0;
+  if (brightness > 1.0)
+    brightness = 1.0;
+
+  r = (color >> 16) & 0xFF;
+  g = (color >> 8) & 0xFF;
+  b = color & 0xFF;
+
+  r = (int)(r * brightness);
+  g = (int)(g * brightness);
+  b = (int)(b * brightness);
+
+  r = (r > 255) ? 255 : (r < 0 ? 0 : r);
+  g = (g > 255) ? 255 : (g < 0 ? 0 : g);
+  b = (b > 255) ? 255 : (b < 0 ? 0 : b);
+
+  return (r << 16) | (g << 8) | b;
+}
+
+// --- Drawing Functions ---
+
+static t_face hit_face(t_params *params, const t_ray_hit *hit) {
+  if (params->map.map_data[hit->map_y][hit->map_x] == DOOR)
+    return FACE_DOOR;
+  if (hit->is_vertical)
+    return cos(hit->ray_angle) > 0 ? FACE_WEST : FACE_EAST;
+  return sin(hit->ray_angle) > 0 ? FACE_NORTH : FACE_SOUTH;
+}
+
+// Texture coordinate across the face, increasing left to right on screen.
+static double hit_tex_u(t_params *params, const t_ray_hit *hit) {
+  double along = hit->is_vertical ? hit->hit_point.y : hit->hit_point.x;
+  double u = along / TILE_SIZE - floor(along / TILE_SIZE);
+  t_door *door;
+
+  if (hit->face == FACE_DOOR) {
+    door = door_at(params, hit->map_x, hit->map_y);
+    return door ? u - door->open : u; // The door slid by open
+  }
+  if (hit->face == FACE_EAST || hit->face == FACE_NORTH)
+    return 1.0 - u;
+  return u;
+}
+
+static void cast_ray(t_params *params, double ray_angle, t_ray_hit *hit) {
+  t_fpoint h_intersect, v_intersect;
+  double h_dist_sq, v_dist_sq;
+
+  h_intersect = find_horizontal_wall_intersection(params, ray_angle);
+  v_intersect = find_vertical_wall_intersection(params, ray_angle);
+
+  h_dist_sq = (h_intersect.x != INT_MAX)
+                  ? pow(h_intersect.x - params->player.x, 2) +
+                        pow(h_intersect.y - params->player.y, 2)
+                  : __DBL_MAX__;
+  v_dist_sq = (v_intersect.x != INT_MAX)
+                  ? pow(v_intersect.x - params->player.x, 2) +
+                        pow(v_intersect.y - params->player.y, 2)
+                  : __DBL_MAX__;
+
+  if (h_dist_sq < v_dist_sq) {
+    hit->distance = sqrt(h_dist_sq);
+    hit->hit_point = h_intersect;
+    hit->is_vertical = false;
+  } else {
+    hit->distance = sqrt(v_dist_sq);
+    hit->hit_point = v_intersect;
+    hit->is_vertical = true;
+  }
+
+  COUNT_RAY();
+  hit->distance *=
+      cos(ray_angle - params->player.direction); // Fisheye correction
+  hit->ray_angle = ray_angle;
+  hit->height = 0;
+
+  if (hit->distance < __DBL_MAX__) {
+    double check_x = hit->hit_point.x;
+    double check_y = hit->hit_point.y;
+    // Nudge along the ray so the point lands in the cell that was hit
+    if (hit->is_vertical) {
+      check_x += (cos(ray_angle) > 0 ? 0.01 : -0.01);
+    } else {
+      check_y += (sin(ray_angle) > 0 ? 0.01 : -0.01);
+    }
+    hit->map_x = (int)(check_x / TILE_SIZE);
+    hit->map_y = (int)(check_y / TILE_SIZE);
+    hit->face = hit_face(params, hit);
+  } else {
+    hit->map_x = -1;
+    hit->map_y = -1;
+  }
+}
+
+/**
+ * Casts the rays of the columns whose mask entry is set (all of them when
+ * mask is NULL). The other entries of ray_hits are left untouched.
+ */
+void cast_rays_masked(t_params *params, t_ray_hit *ray_hits,
+                      const unsigned char *mask) {
+  double angle_step = PLAYER_FOV / (double)NUM_RAYS;
+  double ray_angle = params->player.direction - (PLAYER_FOV / 2.0);
+  int i;
+
+  for (i = 0; i < NUM_RAYS; i++) {
+    if (!mask || mask[i])
+      cast_ray(params, normalize_angle(ray_angle), &ray_hits[i]);
+    ray_angle += angle_step;
+  }
+}
+
+void cast_rays(t_params *params, t_ray_hit *ray_hits) {
+  cast_rays_masked(params, ray_hits, NULL);
+}
+
+void draw_vertical_slice_direct(t_params *params, int x, int y_start, int y_end,
+                                int base_color, double distance) {
+  int y, shaded_color;
+  char *pixel_addr;
+  int pixel_bytes = params->window_img.bpp;
+
+  if (x < 0 || x >= params->window_img.width)
+    return;
+  int clamped_y_start = (y_start < 0) ? 0 : y_start;
+  int clamped_y_end = (y_end >= params->window_img.height)
+                          ? params->window_img.height - 1
+                          : y_end;
+
+  if (clamped_y_start > clamped_y_end)
+    return; // Nothing to draw
+
+  shaded_color = apply_shading(base_color, distance);
+  pixel_addr = params->window_img.addr +
+               (clamped_y_start * params->window_img.line_length) +
+               (x * pixel_bytes);
+  COUNT_VIEW(clamped_y_end - clamped_y_start + 1, 0);
+
+  for (y = clamped_y_start; y <= clamped_y_end; y++) {
+    *(unsigned int *)pixel_addr = shaded_color;
+    pixel_addr += params->window_img.line_length;
+  }
+}
+
+// --- Wall Spans ---
+//
+// Neighbouring columns that hit the same face of the same cell see one
+// planar quad, so render_3d_view groups them into spans of at most
+// SPAN_MAX_COLUMNS. The light and the texture coordinate are only worked
+// out for the two end columns. A ray's direction is the view axis plus
+// tan(offset) times the screen axis, which makes 1/z and u/z of a plane
+// affine in that tangent, so interpolating them over column_tan is exact.
+// Each column then costs one division, 1/(1/z), and hands its height and
+// texture step to the drawer instead of the drawer recomputing them.
+
+static bool hit_visible(const t_ray_hit *hit) {
+  return hit->distance < MAX_VISIBLE_DISTANCE && hit->distance > 0.01;
+}
+
+static bool same_face(const t_ray_hit *a, const t_ray_hit *b) {
+  return hit_visible(a) && a->map_x == b->map_x && a->map_y == b->map_y &&
+         a->face == b->face;
+}
+
+/**
+ * End of the span starting at x0. With a mask, only the columns it sets
+ * are compared and the span ends on one of them: the others hold hits
+ * reprojected from the last frame, which cast columns must not
+ * interpolate towards.
+ */
+static int span_end(t_ray_hit *ray_hits, int x0, const unsigned char *mask) {
+  int x, end = x0 + 1;
+
+  if (!hit_visible(&ray_hits[x0]))
+    return end;
+  for (x = x0 + 1; x < NUM_RAYS && x - x0 < SPAN_MAX_COLUMNS; x++) {
+    if (mask && !mask[x])
+      continue;
+    if (!same_face(&ray_hits[x], &ray_hits[x0]))
+      break;
+    end = x + 1;
+  }
+  return end;
+}
+
+// RGB565 twin of the wall loop in draw_wall_column, rows span.x..span.y.
+static void draw_column_565(t_params *params, t_face face, int tex_x,
+                            t_point span, unsigned int tex_pos,
+                            unsigned int tex_step, unsigned int brightness,
+                            char *dst) {
+  const t_texture16 *tex = &params->wall_textures16[face];
+  const unsigned short *column = tex->texels + tex_x * tex->height;
+  const t_rgb565_lut *lut = &params->rgb565;
+  unsigned int t;
+  int y;
+
+  for (y = span.x; y <= span.y; y++) {
+    t = column[tex_pos >> 16];
+    *(unsigned int *)dst =
+        shade_color(lut->lo[t & 0xFF] | lut->hi[t >> 8], brightness);
+    tex_pos += tex_step;
+    dst += params->window_img.line_length;
+  }
+}
+
+static void draw_wall_column(t_params *params, int x, const t_wall_slice *s) {
+  t_texture *tex = &params->wall_textures[s->face];
+  t_img *img = &params->window_img;
+  int height = s->height;
+  int top = img->height / 2 - height / 2;
+  int y0 = (top < 0) ? 0 : top;
+  int y1 = (top + height >= img->height) ? img->height - 1 : top + height;
+  int tex_x = (int)(s->u * tex->width);
+  unsigned int brightness, *column, tex_pos, tex_step = s->tex_step;
+  char *dst;
+
+  if (!params->sky_enabled)
+    draw_vertical_slice_direct(params, x, 0, top - 1, C_CEILING,
+                               MAX_VISIBLE_DISTANCE);
+  draw_vertical_slice_direct(params, x, top + height + 1, img->height - 1,
+                             C_FLOOR, MAX_VISIBLE_DISTANCE);
+  if (height <= 0)
+    return;
+  tex_x = (tex_x < 0) ? 0 : (tex_x >= tex->width ? tex->width - 1 : tex_x);
+  brightness =
+      (unsigned int)(s->light * (1.0 - s->distance / MAX_VISIBLE_DISTANCE));
+  column = tex->texels + tex_x * tex->height;
+  tex_pos = (y0 - top) * tex_step;
+  dst = img->addr + y0 * img->line_length + x * img->bpp;
+  COUNT_VIEW(y1 - y0 + 1, y1 - y0 + 1);
+  if (params->textures_565) {
+    draw_column_565(params, s->face, tex_x, (t_point){y0, y1}, tex_pos, tex_step,
+                    brightness, dst);
+    return;
+  }
+  for (; y0 <= y1; y0++) {
+    *(unsigned int *)dst = shade_color(column[tex_pos >> 16], brightness);
+    tex_pos += tex_step;
+    dst += img->line_length;
+  }
+}
+
+static void draw_wall_span(t_params *params, t_ray_hit *ray_hits, int x0,
+                           int x1, const unsigned char *mask) {
+  t_ray_hit *a = &ray_hits[x0], *b = &ray_hits[x1 - 1];
+  const double *tan_x = params->column_tan;
+  double plane = TILE_SIZE * params->dist_proj_plane;
+  double inv_z = 1.0 / a->distance, u_z = hit_tex_u(params, a) * inv_z;
+  double d_inv_z = 0.0, d_u_z = 0.0, step_z, t, w;
+  unsigned char level = lighting_sample_hit(params, a);
+  t_wall_slice s;
+  int x;
+
+  s.face = a->face;
+  s.light = (level == LIGHT_FULL) ? 256 : params->lighting.lut[level];
+  // Texels per pixel times z, one short of 1.0 so the last row of the
+  // column stays inside the texture
+  step_z = ((double)params->wall_textures[s.face].height * 65536.0 - 1.0) /
+           plane;
+  if (x1 - x0 > 1) {
+    t = tan_x[x1 - 1] - tan_x[x0];
+    d_inv_z = (1.0 / b->distance - inv_z) / t;
+    d_u_z = (hit_tex_u(params, b) / b->distance - u_z) / t;
+  }
+  params->span_stats.spans++;
+  for (x = x0; x < x1; x++) {
+    if (mask && !mask[x])
+      continue;
+    t = tan_x[x] - tan_x[x0];
+    w = inv_z + d_inv_z * t;
+    s.distance = 1.0 / w;
+    s.u = (u_z + d_u_z * t) * s.distance;
+    s.height = (int)(plane * w);
+    s.tex_step = (unsigned int)(s.distance * step_z);
+    ray_hits[x].height = s.height; // Fog covers exactly the drawn rows
+    if (params->indexed.enabled)
+      indexed_draw_wall_column(params, x, &s);
+    else
+      draw_wall_column(params, x, &s);
+    params->span_stats.columns++;
+    params->span_stats.coalesced += (x1 - x0 > 1);
+  }
+}
+
+// Ceiling and floor of a column whose ray hit nothing in range.
+static void draw_empty_column(t_params *params, int x) {
+  int half = params->window_img.height / 2;
+
+  if (params->indexed.enabled) {
+    if (!params->sky_enabled)
+      indexed_draw_fill(params, x, 0, half - 1, C_CEILING,
+                        MAX_VISIBLE_DISTANCE);
+    indexed_draw_fill(params, x, half, params->window_img.height - 1, C_FLOOR,
+                      MAX_VISIBLE_DISTANCE);
+    return;
+  }
+  if (!params->sky_enabled)
+    draw_vertical_slice_direct(params, x, 0, half - 1, C_CEILING,
+                               MAX_VISIBLE_DISTANCE);
+  draw_vertical_slice_direct(params, x, half, params->window_img.height - 1,
+                             C_FLOOR, MAX_VISIBLE_DISTANCE);
+}
+
+// --- Sky ---
+//
+// The sky's horizontal offset depends only on the ray angle, and rays are
+// evenly spaced with one sky texel per column, so the column-to-texel
+// mapping of a frame is a single offset: each screen row above the
+// horizon is one contiguous run of its sky row, split in two where the
+// panorama wraps. Walls then overwrite the part of the sky they cover.
+
+static void draw_sky(t_params *params) {
+  t_texture *sky = &params->sky;
+  t_img *img = &params->window_img;
+  double left = normalize_angle(params->player.direction - PLAYER_FOV / 2.0);
+  int first = (int)(left / (2.0 * M_PI) * sky->width) % sky->width;
+  int run = sky->width - first;
+  int rows = (img->height / 2 < sky->height) ? img->height / 2 : sky->height;
+  int y;
+
+  if (params->indexed.enabled) {
+    indexed_draw_sky(params, first);
+    return;
+  }
+  if (run > img->width)
+    run = img->width;
+  COUNT_VIEW(rows * img->width, rows * img->width);
+  for (y = 0; y < rows; y++) {
+    char *dst = img->addr + y * img->line_length;
+    const unsigned int *src = sky->texels + y * sky->width;
+
+    memcpy(dst, src + first, run * sizeof(*src));
+    if (run < img->width)
+      memcpy(dst + run * sizeof(*src), src, (img->width - run) * sizeof(*src));
+  }
+}
+
+/**
+ * Draws walls, ceiling and floor for the columns whose mask entry is set
+ * (all of them when mask is NULL). Spans are built from those columns
+ * only, so a rendered column interpolates between hits cast this frame.
+ * The sky is drawn across the whole width; interlaced frames overwrite the
+ * columns they reconstruct.
+ */
+void render_3d_view_masked(t_params *params, t_ray_hit *ray_hits,
+                           const unsigned char *mask) {
+  int x0, x1;
+
+  params->span_stats.frames++;
+  if (params->sky_enabled)
+    draw_sky(params);
+  for (x0 = 0; x0 < NUM_RAYS; x0 = x1) {
+    x1 = x0 + 1;
+    if (mask && !mask[x0])
+      continue;
+    x1 = span_end(ray_hits, x0, mask);
+    if (hit_visible(&ray_hits[x0])) {
+      draw_wall_span(params, ray_hits, x0, x1, mask);
+      continue;
+    }
+    params->span_stats.columns++;
+    draw_empty_column(params, x0);
+  }
+}
+
+void render_3d_view(t_params *params, t_ray_hit *ray_hits) {
+  render_3d_view_masked(params, ray_hits, NULL);
+}
+
+/**
+ * Generates the wall textures, one per face direction plus doors, with
+ * their RGB565 copies, and the sky panorama, which starts enabled.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int render_init(t_params *params) {
+  int i;
+
+  for (i = 0; i < WALL_TEXTURES; i++)
+    if (texture_generate_wall(&params->wall_textures[i], i) != 0 ||
+        texture_pack_565(&params->wall_textures16[i],
+                         &params->wall_textures[i]) != 0)
+      return -1;
+  rgb565_lut_init(&params->rgb565);
+  if (texture_generate_sky(&params->sky, SKY_WIDTH, SKY_HEIGHT) != 0)
+    return -1;
+  for (i = 0; i < NUM_RAYS; i++)
+    params->column_tan[i] =
+        tan(-PLAYER_FOV / 2.0 + i * (PLAYER_FOV / (double)NUM_RAYS));
+  params->sky_enabled = true;
+  return indexed_init(params);
+}
+
+void render_free(t_params *params) {
+  int i;
+
+  for (i = 0; i < WALL_TEXTURES; i++) {
+    texture_free(&params->wall_textures[i]);
+    texture16_free(&params->wall_textures16[i]);
+  }
+  texture_free(&params->sky);
+  indexed_free(params);
+}
+
+// How much of the view the wall spans have covered so far.
+void render_report_spans(t_params *params, FILE *out) {
+  t_span_stats *s = &params->span_stats;
+
+  if (s->frames == 0 || s->columns == 0)
+    return;
+  fprintf(out,
+          "spans: %.1f spans/frame, %.1f of %.1f drawn columns/frame "
+          "coalesced (%.1f%%)\n",
+          (double)s->spans / s->frames, (double)s->coalesced / s->frames,
+          (double)s->columns / s->frames, 100.0 * s->coalesced / s->columns);
+}
+
+// --- Frame Composition ---
+
+/**
+ * Renders one complete frame into params->window_img. This is the whole
+ * per-frame workload shared by the single-threaded loop and the render
+ * thread; it only reads the player and map.
+ */
+void render_frame(t_params *params, t_ray_hit *ray_hits) {
+  PROF_FRAME();
+  COUNT_FRAME();
+  PROF_BEGIN(PROF_CLEAR);
+  clear_image_direct(params, C_BLACK);
+  PROF_END(PROF_CLEAR);
+  if (params->interlace.enabled && !params->indexed.enabled) {
+    PROF_BEGIN(PROF_WALLS); // Casting is interleaved with the walls here
+    interlace_render(params, ray_hits);
+    PROF_END(PROF_WALLS);
+  } else {
+    PROF_BEGIN(PROF_CAST);
+    cast_rays(params, ray_hits);
+    PROF_END(PROF_CAST);
+    PROF_BEGIN(PROF_WALLS);
+    render_3d_view(params, ray_hits);
+    if (params->indexed.enabled)
+      indexed_expand(params);
+    PROF_END(PROF_WALLS);
+  }
+  PROF_BEGIN(PROF_POST);
+  post_process(params, ray_hits);
+  PROF_END(PROF_POST);
+  PROF_BEGIN(PROF_SPRITES);
+  render_sprites(params, ray_hits);
+  PROF_END(PROF_SPRITES);
+
+#ifdef DRAW_MINIMAP // Compile with -D DRAW_MINIMAP to enable
+  PROF_BEGIN(PROF_MINIMAP);
+  draw_map(params);
+  draw_rays_minimap(params, ray_hits);
+  draw_player(params);
+  PROF_END(PROF_MINIMAP);
+#endif
+}
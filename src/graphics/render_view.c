@@ -0,0 +1,175 @@
+#include "../../include/cub3d.h"
+
+// --- Render View ---
+//
+// The render thread draws from its own t_params, the view, so it holds
+// world_lock only while view_sync copies the frame's inputs, not for the
+// whole frame. The view starts as a shallow copy of params: textures,
+// sprites, palette tables and everything else fixed by world_load stay
+// shared. It owns copies of what the main thread mutates (map cells,
+// doors, light levels, the minimap pyramid) and, from then on, the
+// renderer's own state: interlace history, minimap layer, post tables and
+// span statistics.
+
+static char **copy_rows(const t_map *map) {
+  char **rows = malloc(map->rows * sizeof(*rows));
+  char *cells = malloc((size_t)map->rows * (map->cols + 1));
+  int y;
+
+  if (!rows || !cells) {
+    free(rows);
+    free(cells);
+    return NULL;
+  }
+  for (y = 0; y < map->rows; y++) {
+    rows[y] = cells + (size_t)y * (map->cols + 1);
+    ft_memcpy(rows[y], map->map_data[y], map->cols + 1);
+  }
+  return rows;
+}
+
+static size_t lod_size(const t_minimap *mm, int level) {
+  return (size_t)mm->lod_dim[level].x * mm->lod_dim[level].y;
+}
+
+/**
+ * Creates the render thread's view of params. Call before the thread
+ * starts, or with world_lock held.
+ *
+ * @return the view, or NULL on allocation failure
+ */
+t_params *view_new(t_params *params) {
+  t_params *view = malloc(sizeof(*view));
+  size_t cells = (size_t)params->map.rows * params->map.cols;
+  int level;
+
+  if (!view)
+    return NULL;
+  *view = *params;
+  view->map.map_data = copy_rows(&params->map);
+  view->doors.capacity = params->doors.count;
+  view->doors.items = malloc((params->doors.count + 1) * sizeof(t_door));
+  view->doors.cell_door = malloc(cells * sizeof(int));
+  view->lighting.cells = malloc(cells);
+  for (level = 0; level < MINIMAP_LOD_LEVELS; level++)
+    view->minimap.lod[level] =
+        (level < params->minimap.levels)
+            ? malloc(lod_size(&params->minimap, level))
+            : NULL;
+  for (level = 0; level < params->minimap.levels; level++)
+    if (!view->minimap.lod[level])
+      break;
+  if (!view->map.map_data || !view->doors.items || !view->doors.cell_door ||
+      !view->lighting.cells || level < params->minimap.levels) {
+    view_free(view, params);
+    return NULL;
+  }
+  params->minimap.dirty = true; // The first sync copies the pyramid
+  params->minimap.dirty_min = (t_point){0, 0};
+  params->minimap.dirty_max = (t_point){0, 0};
+  return view;
+}
+
+static int sync_doors(t_doors *dst, const t_doors *src, size_t cells) {
+  t_door *items;
+
+  if (src->count > dst->capacity) {
+    items = realloc(dst->items, src->count * sizeof(*items));
+    if (!items)
+      return -1;
+    dst->items = items;
+    dst->capacity = src->count;
+  }
+  ft_memcpy(dst->items, src->items, src->count * sizeof(*dst->items));
+  dst->count = src->count;
+  ft_memcpy(dst->cell_door, src->cell_door, cells * sizeof(int));
+  return 0;
+}
+
+// Takes over the cells the main thread marked for a minimap repaint.
+static void sync_minimap(t_minimap *dst, t_minimap *src) {
+  int level;
+
+  dst->zoom = src->zoom;
+  if (!src->dirty)
+    return;
+  for (level = 0; level < src->levels; level++)
+    ft_memcpy(dst->lod[level], src->lod[level], lod_size(src, level));
+  if (!dst->dirty) {
+    dst->dirty_min = src->dirty_min;
+    dst->dirty_max = src->dirty_max;
+  } else {
+    if (src->dirty_min.x < dst->dirty_min.x)
+      dst->dirty_min.x = src->dirty_min.x;
+    if (src->dirty_min.y < dst->dirty_min.y)
+      dst->dirty_min.y = src->dirty_min.y;
+    if (src->dirty_max.x > dst->dirty_max.x)
+      dst->dirty_max.x = src->dirty_max.x;
+    if (src->dirty_max.y > dst->dirty_max.y)
+      dst->dirty_max.y = src->dirty_max.y;
+  }
+  dst->dirty = true;
+  src->dirty = false;
+}
+
+/**
+ * Copies what the next frame reads from params into the view: the player
+ * posed for now_us, cells, doors, light levels, the rendering options and
+ * pending invalidations. params->interlace.valid only tells the render
+ * thread that its history went stale, so it is set again once taken over.
+ * Hands the renderer's statistics back for the key reports. Call with
+ * world_lock held.
+ *
+ * @return 0 on success, -1 if the view could not grow for new doors; it
+ *         then keeps the previous doors
+ */
+int view_sync(t_params *view, t_params *params, long now_us) {
+  size_t cells = (size_t)params->map.rows * params->map.cols;
+  unsigned char *light_cells = view->lighting.cells;
+  int y, status;
+
+  for (y = 0; y < params->map.rows; y++)
+    ft_memcpy(view->map.map_data[y], params->map.map_data[y],
+              params->map.cols);
+  status = sync_doors(&view->doors, &params->doors, cells);
+  view->lighting = params->lighting;
+  view->lighting.cells = light_cells;
+  ft_memcpy(light_cells, params->lighting.cells, cells);
+  sync_minimap(&view->minimap, &params->minimap);
+  view->sky_enabled = params->sky_enabled;
+  view->textures_565 = params->textures_565;
+  view->indexed.enabled = params->indexed.enabled;
+  view->post.flags = params->post.flags;
+  view->interlace.enabled = params->interlace.enabled;
+  if (!params->interlace.valid) {
+    view->interlace.valid = false;
+    params->interlace.valid = true;
+  }
+  view->player = sim_pose_at(params, now_us);
+  params->span_stats = view->span_stats;
+  params->interlace.stats = view->interlace.stats;
+  return status;
+}
+
+/**
+ * Hands the renderer's state back to params, so world_free releases and
+ * reports it, and frees the view's copies. Call once the render thread
+ * has stopped.
+ */
+void view_free(t_params *view, t_params *params) {
+  int level;
+
+  if (!view)
+    return;
+  params->interlace = view->interlace;
+  params->span_stats = view->span_stats;
+  if (view->map.map_data)
+    free(view->map.map_data[0]);
+  free(view->map.map_data);
+  free(view->doors.items);
+  free(view->doors.cell_door);
+  free(view->lighting.cells);
+  for (level = 0; level < MINIMAP_LOD_LEVELS; level++)
+    free(view->minimap.lod[level]);
+  free(view);
+}
@@ -0,0 +1,253 @@
+#include "../../include/cub3d.h"
+
+// --- Sprites ---
+//
+// Billboards are projected with the same angle-per-column mapping as
+// cast_rays and tested against the per-column perpendicular wall distances
+// of the frame (the 1D z-buffer). Only sprites returned by a view-cone
+// query on the spatial grid are considered, so off-screen sprites cost
+// nothing per frame. A candidate is still rejected before any pixel work
+// when every ZBUFFER_TILE block of columns it covers is closer than the
+// sprite. Survivors are drawn far to near as clipped vertical texture
+// spans, so the cost follows the number of visible sprite pixels. Sprites
+// are drawn over the post-processed frame and fog, vignette and gamma
+// their own pixels, fogged by the sprite's depth rather than the wall's.
+
+/**
+ * Generates the sprite textures and builds the spatial grid over the map,
+ * registering the sprites added while the map was parsed.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int sprites_init(t_params *params) {
+  t_sprites *s = &params->sprites;
+  int i;
+
+  for (i = 0; i < SPRITE_TEXTURES; i++)
+    if (texture_generate_sprite(&s->textures[i], i) != 0)
+      return -1;
+  if (grid_init(&s->grid, params->map.cols, params->map.rows, TILE_SIZE) != 0)
+    return -1;
+  for (i = 0; i < s->count; i++)
+    if (grid_insert(&s->grid, i, s->items[i].x, s->items[i].y) != 0)
+      return -1;
+  return 0;
+}
+
+/**
+ * Adds a sprite at world position (x, y).
+ *
+ * @return the sprite index, or -1 on allocation failure
+ */
+int sprite_add(t_params *params, double x, double y, int texture) {
+  t_sprites *s = &params->sprites;
+  t_sprite *items;
+  t_sprite_ref *visible;
+  int *candidates;
+  int capacity;
+
+  if (s->count == s->capacity) {
+    capacity = s->capacity ? s->capacity * 2 : 16;
+    items = realloc(s->items, capacity * sizeof(*items));
+    if (!items)
+      return -1;
+    s->items = items;
+    candidates = realloc(s->candidates, capacity * sizeof(*candidates));
+    if (!candidates)
+      return -1;
+    s->candidates = candidates;
+    visible = realloc(s->visible, capacity * sizeof(*visible));
+    if (!visible)
+      return -1;
+    s->visible = visible;
+    s->capacity = capacity;
+  }
+  if (s->grid.heads && grid_insert(&s->grid, s->count, x, y) != 0)
+    return -1;
+  s->items[s->count] = (t_sprite){x, y, texture % SPRITE_TEXTURES, 0.0, 0.0};
+  return s->count++;
+}
+
+void sprites_free(t_params *params) {
+  t_sprites *s = &params->sprites;
+  int i;
+
+  for (i = 0; i < SPRITE_TEXTURES; i++)
+    texture_free(&s->textures[i]);
+  grid_free(&s->grid);
+  free(s->items);
+  free(s->candidates);
+  free(s->visible);
+  s->items = NULL;
+  s->candidates = NULL;
+  s->visible = NULL;
+  s->count = 0;
+  s->capacity = 0;
+}
+
+/**
+ * Scales the RGB channels of a colour by brightness / 256, two channels
+ * per multiply.
+ */
+unsigned int shade_color(unsigned int color, unsigned int brightness) {
+  unsigned int rb = ((color & 0xFF00FF) * brightness) >> 8;
+  unsigned int g = ((color & 0x00FF00) * brightness) >> 8;
+
+  return (rb & 0xFF00FF) | (g & 0x00FF00);
+}
+
+static int compare_far_to_near(const void *a, const void *b) {
+  double da = ((const t_sprite_ref *)a)->depth;
+  double db = ((const t_sprite_ref *)b)->depth;
+
+  return (da < db) - (da > db);
+}
+
+static void build_zmax(t_sprites *s, t_ray_hit *ray_hits) {
+  int tile, i, end;
+
+  for (tile = 0; tile * ZBUFFER_TILE < NUM_RAYS; tile++) {
+    s->zmax[tile] = 0.0;
+    end = (tile + 1) * ZBUFFER_TILE;
+    if (end > NUM_RAYS)
+      end = NUM_RAYS;
+    for (i = tile * ZBUFFER_TILE; i < end; i++)
+      if (ray_hits[i].distance > s->zmax[tile])
+        s->zmax[tile] = ray_hits[i].distance;
+  }
+}
+
+static bool fully_occluded(t_sprites *s, int x0, int x1, double depth) {
+  int tile;
+
+  for (tile = x0 / ZBUFFER_TILE; tile <= (x1 - 1) / ZBUFFER_TILE; tile++)
+    if (s->zmax[tile] > depth)
+      return false;
+  return true;
+}
+
+typedef struct s_sprite_proj {
+  double left;   // Screen column of the left edge (may be off-screen)
+  double width;  // Width in columns
+  int top;       // Screen row of the top edge (may be off-screen)
+  int height;    // Height in rows
+  unsigned int brightness; // Light and distance falloff times fog keep
+  unsigned int fog;        // Fog colour times (256 - keep), added after
+} t_sprite_proj;
+
+// Vignette and gamma of one sprite pixel, as post_process applies them.
+static inline unsigned int post_pixel(const t_post *pp, unsigned int c, int x,
+                                      int y) {
+  const unsigned char *gm = pp->gamma;
+
+  if (pp->flags & POST_VIGNETTE)
+    c = shade_color(c, (pp->vig_x[x] * pp->vig_y[y]) >> 8);
+  if (pp->flags & POST_GAMMA)
+    c = (unsigned int)gm[(c >> 16) & 0xFF] << 16 |
+        (unsigned int)gm[(c >> 8) & 0xFF] << 8 | gm[c & 0xFF];
+  return c;
+}
+
+static void draw_sprite_column(t_params *params, t_texture *tex,
+                               t_sprite_proj *pr, int x) {
+  t_img *img = &params->window_img;
+  bool post = params->post.flags & (POST_VIGNETTE | POST_GAMMA);
+  int tex_x = (int)((x - pr->left) * tex->width / pr->width);
+  int y0 = (pr->top < 0) ? 0 : pr->top;
+  int y1 = pr->top + pr->height;
+  unsigned int *column, texel;
+  unsigned int tex_pos, tex_step;
+  char *dst;
+
+  if (y1 > img->height)
+    y1 = img->height;
+  if (tex_x < 0)
+    tex_x = 0;
+  else if (tex_x >= tex->width)
+    tex_x = tex->width - 1;
+  column = tex->texels + tex_x * tex->height;
+  tex_step = ((unsigned int)tex->height << 16) / pr->height;
+  tex_pos = (y0 - pr->top) * tex_step;
+  dst = img->addr + y0 * img->line_length + x * img->bpp;
+  for (; y0 < y1; y0++) {
+    texel = column[tex_pos >> 16];
+    if (!(texel & TEXTURE_TRANSPARENT)) {
+      texel = shade_color(texel, pr->brightness) + pr->fog;
+      *(unsigned int *)dst = post ? post_pixel(&params->post, texel, x, y0)
+                                  : texel;
+    }
+    tex_pos += tex_step;
+    dst += img->line_length;
+  }
+}
+
+static void draw_sprite(t_params *params, t_sprite *sp, t_ray_hit *ray_hits) {
+  t_sprites *s = &params->sprites;
+  double dx = sp->x - params->player.x, dy = sp->y - params->player.y;
+  double angle_step = PLAYER_FOV / (double)NUM_RAYS;
+  double angle, half_width;
+  t_sprite_proj pr;
+  unsigned int keep;
+  int x, x0, x1;
+
+  angle = atan2(sp->lateral, sp->depth);
+  half_width = atan2(TILE_SIZE / 2.0, hypot(dx, dy)) / angle_step;
+  pr.left = (angle + PLAYER_FOV / 2.0) / angle_step - half_width;
+  pr.width = 2.0 * half_width;
+  x0 = (int)ceil(pr.left);
+  x1 = (int)ceil(pr.left + pr.width);
+  x0 = (x0 < 0) ? 0 : x0;
+  x1 = (x1 > NUM_RAYS) ? NUM_RAYS : x1;
+  if (x0 >= x1 || fully_occluded(s, x0, x1, sp->depth))
+    return;
+  pr.height = (int)(TILE_SIZE / sp->depth * params->dist_proj_plane);
+  if (pr.height <= 0)
+    return;
+  pr.top = params->window_img.height / 2 - pr.height / 2;
+  pr.brightness = (unsigned int)(256.0 * (1.0 - sp->depth / MAX_VISIBLE_DISTANCE));
+  if (params->lighting.enabled)
+    pr.brightness *= params->lighting.lut[lighting_sample(params, sp->x,
+                                                           sp->y)] / 256.0;
+  keep = (params->post.flags & POST_FOG) ? post_fog_keep(sp->depth) : 256;
+  pr.brightness = pr.brightness * keep >> 8;
+  pr.fog = shade_color(FOG_COLOR, 256 - keep);
+  s->drawn++;
+  for (x = x0; x < x1; x++)
+    if (ray_hits[x].distance > sp->depth)
+      draw_sprite_column(params, &s->textures[sp->texture], &pr, x);
+}
+
+/**
+ * Draws all sprites over the wall pass, using ray_hits[].distance as the
+ * z-buffer. Must run after render_3d_view for the same ray_hits, and
+ * after post_process.
+ */
+void render_sprites(t_params *params, t_ray_hit *ray_hits) {
+  t_sprites *s = &params->sprites;
+  double cos_dir = cos(params->player.direction);
+  double sin_dir = sin(params->player.direction);
+  t_grid_frustum view;
+  t_sprite *sp;
+  int i, n, visible = 0;
+
+  s->drawn = 0;
+  if (s->count == 0 || params->window_img.bpp != 4)
+    return;
+  view = (t_grid_frustum){params->player.x, params->player.y,
+                          params->player.direction, PLAYER_FOV / 2.0,
+                          MAX_VISIBLE_DISTANCE, TILE_SIZE / 2.0};
+  n = grid_query_frustum(&s->grid, &view, s->candidates, s->count);
+  for (i = 0; i < n; i++) {
+    sp = &s->items[s->candidates[i]];
+    sp->depth = (sp->x - params->player.x) * cos_dir +
+                (sp->y - params->player.y) * sin_dir;
+    sp->lateral = (sp->y - params->player.y) * cos_dir -
+                  (sp->x - params->player.x) * sin_dir;
+    if (sp->depth > SPRITE_NEAR_PLANE && sp->depth < MAX_VISIBLE_DISTANCE)
+      s->visible[visible++] = (t_sprite_ref){sp->depth, s->candidates[i]};
+  }
+  qsort(s->visible, visible, sizeof(*s->visible), compare_far_to_near);
+  build_zmax(s, ray_hits);
+  for (i = 0; i < visible; i++)
+    draw_sprite(params, &s->items[s->visible[i].index], ray_hits);
+}
@@ -0,0 +1,187 @@
+#include "../../include/cub3d.h"
+
+// --- Textures ---
+
+int texture_alloc(t_texture *tex, int width, int height) {
+  tex->width = width;
+  tex->height = height;
+  tex->texels = malloc((size_t)width * height * sizeof(unsigned int));
+  return tex->texels ? 0 : -1;
+}
+
+void texture_free(t_texture *tex) {
+  free(tex->texels);
+  tex->texels = NULL;
+}
+
+/**
+ * Packs src into a newly allocated RGB565 texture, rounding each channel
+ * to nearest. Transparency is not kept; only wall textures are packed.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int texture_pack_565(t_texture16 *dst, const t_texture *src) {
+  size_t i, n = (size_t)src->width * src->height;
+  unsigned int c, r, g, b;
+
+  dst->width = src->width;
+  dst->height = src->height;
+  dst->texels = malloc(n * sizeof(*dst->texels));
+  if (!dst->texels)
+    return -1;
+  for (i = 0; i < n; i++) {
+    c = src->texels[i];
+    r = (((c >> 16) & 0xFF) * 31 + 127) / 255;
+    g = (((c >> 8) & 0xFF) * 63 + 127) / 255;
+    b = ((c & 0xFF) * 31 + 127) / 255;
+    dst->texels[i] = (unsigned short)((r << 11) | (g << 5) | b);
+  }
+  return 0;
+}
+
+void texture16_free(t_texture16 *tex) {
+  free(tex->texels);
+  tex->texels = NULL;
+}
+
+/**
+ * Builds the two byte tables that expand an RGB565 texel. Green straddles
+ * the bytes, but its replicated low bits come from the high byte only, so
+ * the two halves never overlap and can be OR-ed.
+ */
+void rgb565_lut_init(t_rgb565_lut *lut) {
+  unsigned int i, r, g;
+
+  for (i = 0; i < 256; i++) {
+    r = i >> 3;
+    g = (i & 7) << 3; // Top 3 of the 6 green bits
+    lut->hi[i] = (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8);
+    lut->lo[i] = (((i >> 5) << 2) << 8) | (((i & 31) << 3) | ((i & 31) >> 2));
+  }
+}
+
+static unsigned int sprite_texel(int kind, int x, int y) {
+  int dx, dy, d2, shade;
+
+  if (kind == 0) { // Lamp: glowing orb on a post
+    dx = x - TEXTURE_SIZE / 2;
+    dy = y - TEXTURE_SIZE / 3;
+    d2 = dx * dx + dy * dy;
+    if (d2 < 18 * 18) {
+      shade = 255 - d2 * 160 / (18 * 18);
+      return (shade << 16) | ((shade * 3 / 4) << 8) | (shade / 5);
+    }
+    if (y > TEXTURE_SIZE / 3 && abs(dx) < 3)
+      return C_GRAY;
+    return TEXTURE_TRANSPARENT;
+  }
+  // Barrel with two darker hoops
+  if (x < TEXTURE_SIZE / 4 || x >= TEXTURE_SIZE * 3 / 4 ||
+      y < TEXTURE_SIZE / 3)
+    return TEXTURE_TRANSPARENT;
+  if (abs(y - TEXTURE_SIZE * 5 / 12) < 2 || abs(y - TEXTURE_SIZE * 7 / 8) < 2)
+    return 0x3A2A1A;
+  shade = 0x80 + (x % 8) * 6;
+  return (shade << 16) | ((shade / 2) << 8) | (shade / 5);
+}
+
+/**
+ * Fills tex with one of the built-in TEXTURE_SIZE sprite images. Used when
+ * no sprite artwork is shipped, and in runs without a display.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int texture_generate_sprite(t_texture *tex, int kind) {
+  int x, y;
+
+  if (texture_alloc(tex, TEXTURE_SIZE, TEXTURE_SIZE) != 0)
+    return -1;
+  for (x = 0; x < TEXTURE_SIZE; x++)
+    for (y = 0; y < TEXTURE_SIZE; y++)
+      tex->texels[x * TEXTURE_SIZE + y] = sprite_texel(kind, x, y);
+  return 0;
+}
+
+static unsigned int tint(unsigned int base, int shade) {
+  return shade_color(base, (unsigned int)(shade < 0 ? 0 : shade > 256 ? 256 : shade));
+}
+
+static unsigned int wall_texel(int kind, int x, int y) {
+  int noise = ((x * 7 + y * 13) ^ (x * y)) % 24;
+  int row, offset;
+
+  if (kind == FACE_DOOR) { // Vertical planks in a frame
+    if (x < 4 || x >= TEXTURE_SIZE - 4 || y < 4 || y >= TEXTURE_SIZE - 4)
+      return tint(C_DOOR, 150);
+    return tint(C_DOOR, (x % 16 == 0) ? 120 : 216 + noise);
+  }
+  if (kind == FACE_NORTH || kind == FACE_SOUTH) { // Bricks, staggered rows
+    row = y / 16;
+    offset = (row % 2) ? 16 : 0;
+    if (y % 16 == 0 || (x + offset) % 32 == 0)
+      return 0x303030;
+    return tint(kind == FACE_NORTH ? C_BLUE : 0x2040C0, 200 + noise);
+  }
+  // Large stone blocks
+  if (y % 32 == 0 || x % 32 == 0)
+    return 0x202020;
+  return tint(kind == FACE_EAST ? C_GREEN : 0x20C040, 190 + noise + (y % 32));
+}
+
+/**
+ * Fills tex with the built-in TEXTURE_SIZE wall image for face kind
+ * (FACE_NORTH .. FACE_DOOR).
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int texture_generate_wall(t_texture *tex, int kind) {
+  int x, y;
+
+  if (texture_alloc(tex, TEXTURE_SIZE, TEXTURE_SIZE) != 0)
+    return -1;
+  for (x = 0; x < TEXTURE_SIZE; x++)
+    for (y = 0; y < TEXTURE_SIZE; y++)
+      tex->texels[x * TEXTURE_SIZE + y] = wall_texel(kind, x, y);
+  return 0;
+}
+
+static unsigned int mix(unsigned int a, unsigned int b, int t) {
+  t = (t < 0) ? 0 : (t > 256 ? 256 : t);
+  return shade_color(a, 256 - t) + shade_color(b, t);
+}
+
+/**
+ * Fills tex with a width x height sky panorama covering a full turn:
+ * column x looks at angle 2 pi x / width and the last row touches the
+ * horizon. Everything is periodic in the angle so the seam is invisible.
+ * Unlike the other textures the sky is stored row-major, so the renderer
+ * can copy whole rows of it.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int texture_generate_sky(t_texture *tex, int width, int height) {
+  double a, cloud;
+  int x, y, ridge, t;
+  unsigned int sky;
+
+  if (texture_alloc(tex, width, height) != 0)
+    return -1;
+  for (x = 0; x < width; x++) {
+    a = 2.0 * M_PI * x / width;
+    ridge = height - (int)(height * (0.07 + 0.03 * sin(2 * a) +
+                                     0.02 * sin(5 * a + 1.0) +
+                                     0.008 * sin(17 * a)));
+    cloud = sin(3 * a + 0.8 * sin(7 * a)) + 0.5 * sin(11 * a + 2.0);
+    for (y = 0; y < height; y++) {
+      t = y * 256 / height;
+      sky = mix(0x0B1A40, 0x7FA8D8, t * t / 256);
+      if (y >= ridge) // Distant hills along the horizon
+        sky = mix(0x1C2830, 0x34404A, (y - ridge) * 256 / (height - ridge));
+      else if (y > height / 4 && y < height * 2 / 3)
+        sky = mix(sky, 0xE8ECF0,
+                  (int)((cloud + 0.6 * sin(y * 0.07 + a * 5)) * 90) - 60);
+      tex->texels[y * width + x] = sky;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include "../../mlx/mlx.h"
+#include <stdlib.h>
+#ifndef __APPLE__
+# include "../../mlx/mlx_int.h"
+#endif
+
+/*
+ * Kept apart from cub3d.h because mlx_int.h defines its own t_img.
+ * Draws count segments given as x1, y1, x2, y2 quadruples with a single
+ * XDrawSegments request; coordinates must already be clipped to the
+ * window. Returns the number of segments sent.
+ */
+#ifndef __APPLE__
+
+int	window_draw_segments(void *mlx_ptr, void *win_ptr, const int *coords,
+		int count, int color)
+{
+	t_xvar		*xvar;
+	t_win_list	*win;
+	XSegment	segs[256];
+	XGCValues	xgcv;
+	int			i;
+
+	xvar = mlx_ptr;
+	win = win_ptr;
+	if (count > 256)
+		count = 256;
+	i = -1;
+	while (++i < count)
+	{
+		segs[i].x1 = coords[i * 4];
+		segs[i].y1 = coords[i * 4 + 1];
+		segs[i].x2 = coords[i * 4 + 2];
+		segs[i].y2 = coords[i * 4 + 3];
+	}
+	xgcv.foreground = mlx_get_color_value(mlx_ptr, color);
+	XChangeGC(xvar->display, win->gc, GCForeground, &xgcv);
+	XDrawSegments(xvar->display, win->window, win->gc, segs, count);
+	if (xvar->do_flush)
+		XFlush(xvar->display);
+	return (count);
+}
+
+#else
+
+/*
+ * No XDrawSegments behind the macOS MiniLibX: fall back to an integer
+ * Bresenham through mlx_pixel_put.
+ */
+static void	put_segment(void *mlx_ptr, void *win_ptr, const int *c, int color)
+{
+	int	d[2];
+	int	s[2];
+	int	p[2];
+	int	err;
+	int	e2;
+
+	p[0] = c[0];
+	p[1] = c[1];
+	d[0] = abs(c[2] - p[0]);
+	d[1] = -abs(c[3] - p[1]);
+	s[0] = (p[0] < c[2]) * 2 - 1;
+	s[1] = (p[1] < c[3]) * 2 - 1;
+	err = d[0] + d[1];
+	while (1)
+	{
+		mlx_pixel_put(mlx_ptr, win_ptr, p[0], p[1], color);
+		if (p[0] == c[2] && p[1] == c[3])
+			break ;
+		e2 = 2 * err;
+		if (e2 >= d[1])
+		{
+			err += d[1];
+			p[0] += s[0];
+		}
+		if (e2 <= d[0])
+		{
+			err += d[0];
+			p[1] += s[1];
+		}
+	}
+}
+
+int	window_draw_segments(void *mlx_ptr, void *win_ptr, const int *coords,
+		int count, int color)
+{
+	int	i;
+
+	i = -1;
+	while (++i < count)
+		put_segment(mlx_ptr, win_ptr, coords + i * 4, color);
+	return (count);
+}
+
+#endif
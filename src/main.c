@@ -7,454 +7,80 @@
 #include <stdio.h>            // For fprintf, perror
 #include <stdlib.h>           // For exit, malloc, free
 #include <string.h>           // For memset (or ft_memset)
-#include <sys/time.h>         // For gettimeofday
 #include <unistd.h>           // For usleep
 
-// -------- Constants --------
-#define MAP_SCALE 10
-#define NUM_RAYS WINDOW_WIDTH
-#define PLAYER_FOV (M_PI / 3.0) // 60 degrees
-#define FRAME_RATE_CAP 60
-#define MAX_VISIBLE_DISTANCE (15.0 * TILE_SIZE)
-#define MINIMAP_RAY_STEP 8
-
-// -------- Colors (Example) --------
-#define C_BLACK 0x000000
-#define C_WHITE 0xFFFFFF
-#define C_RED 0xFF0000
-#define C_GREEN 0x00FF00
-#define C_BLUE 0x0000FF
-#define C_YELLOW 0xFFFF00
-#define C_GRAY 0x808080
-#define C_DARK_GRAY 0x404040
-#define C_CEILING 0x303060
-#define C_FLOOR 0x604040
-
-typedef struct s_ray_hit {
-  double distance;
-  t_fpoint hit_point;
-  bool is_vertical;
-  int map_x;
-  int map_y;
-  double ray_angle;
-} t_ray_hit;
-
 // --- Forward Declarations ---
 void init_params(t_params *params);
+void init_window(t_params *params);
 int game_loop(t_params *params);
 int key_press_hook(int keycode, t_params *params);
+int key_release_hook(int keycode, t_params *params);
 int close_window_hook(t_params *params);
-void draw_map(t_params *params);
-void draw_player(t_params *params);
-void cast_rays(t_params *params, t_ray_hit *ray_hits);
-void draw_rays_minimap(t_params *params, t_ray_hit *ray_hits);
-double normalize_angle(double angle);
-void clear_image_direct(t_params *params, int color);
-int is_wall_at(t_params *params, double x, double y);
 void cleanup(t_params *params);
-void render_3d_view(t_params *params, t_ray_hit *ray_hits);
-void draw_vertical_slice_direct(t_params *params, int x, int y_start, int y_end,
-                                int color, double distance);
-long get_time_ms(void);
-void frame_rate_control(long *last_time, int target_fps);
-int apply_shading(int color, double distance);
 
 // Assumed external/libft functions (ensure these are available)
 void *ft_memset(void *b, int c, size_t len);
 char *ft_strdup(const char *s1);
 size_t ft_strlen(const char *s);
-void draw_line_img(t_params *params, t_point p1, t_point p2, int color);
-t_fpoint find_horizontal_wall_intersection(t_params *params, double ray_angle);
-t_fpoint find_vertical_wall_intersection(t_params *params, double ray_angle);
-// Note: put_pixel is replaced by put_pixel_direct
-
-// --- Optimized Drawing & Helpers ---
-
-static inline void put_pixel_direct(t_img *img, int x, int y, int color) {
-  char *dst;
-
-  if (x >= 0 && x < img->width && y >= 0 && y < img->height) {
-    dst = img->addr + (y * img->line_length + x * (img->bpp));
-    *(unsigned int *)dst = color;
-  }
-}
-
-void clear_image_direct(t_params *params, int color) {
-  int y;
-  char *line_start;
-  int pixel_bytes = params->window_img.bpp;
-
-  if (pixel_bytes == 4) {
-    line_start = params->window_img.addr;
-    for (y = 0; y < params->window_img.height; y++) {
-      for (int x = 0; x < params->window_img.width; ++x) {
-        *(unsigned int *)(line_start + x * pixel_bytes) = color;
-      }
-      line_start += params->window_img.line_length;
-    }
-  } else // Fallback for other BPP
-  {
-    for (y = 0; y < params->window_img.height; y++) {
-      for (int x = 0; x < params->window_img.width; x++) {
-        put_pixel_direct(&params->window_img, x, y, color);
-      }
-    }
-  }
-}
-
-double normalize_angle(double angle) {
-  angle = fmod(angle, 2.0 * M_PI);
-  if (angle < 0)
-    angle += (2.0 * M_PI);
-  return angle;
-}
-
-int is_wall_at(t_params *params, double x, double y) {
-  int map_x, map_y;
-
-  if (x < 0 || y < 0 || x >= params->map.cols * TILE_SIZE ||
-      y >= params->map.rows * TILE_SIZE)
-    return 1;
-
-  map_x = (int)(x / TILE_SIZE);
-  map_y = (int)(y / TILE_SIZE);
-
-  if (map_y < 0 || map_y >= params->map.rows || map_x < 0 ||
-      map_x >= params->map.cols)
-    return 1;
-
-  return (params->map.map_data[map_y][map_x] == WALL);
-}
-
-long get_time_ms(void) {
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  return (tv.tv_sec * 1000 + tv.tv_usec / 1000);
-}
-
-void frame_rate_control(long *last_time, int target_fps) {
-  long current_time, elapsed, delay;
-  if (target_fps <= 0)
-    return;
-  current_time = get_time_ms();
-  elapsed = current_time - *last_time;
-  delay = (1000 / target_fps) - elapsed;
-  if (delay > 0)
-    usleep(delay * 1000);
-  *last_time = get_time_ms();
-}
-
-int apply_shading(int color, double distance) {
-  double brightness;
-  int r, g, b;
-
-  if (distance <= 0)
-    return color;
-
-  brightness = 1.0 - (distance / MAX_VISIBLE_DISTANCE);
-  if (brightness < 0.0)
-    brightness = 0.0;
-  if (brightness > 1.0)
-    brightness = 1.0;
-
-  r = (color >> 16) & 0xFF;
-  g = (color >> 8) & 0xFF;
-  b = color & 0xFF;
-
-  r = (int)(r * brightness);
-  g = (int)(g * brightness);
-  b = (int)(b * brightness);
-
-  r = (r > 255) ? 255 : (r < 0 ? 0 : r);
-  g = (g > 255) ? 255 : (g < 0 ? 0 : g);
-  b = (b > 255) ? 255 : (b < 0 ? 0 : b);
-
-  return (r << 16) | (g << 8) | b;
-}
-
-// --- Drawing Functions ---
-
-void draw_map(t_params *params) {
-  int x, y, tile_x, tile_y, color;
-  int draw_x_base, draw_y_base;
-  int map_pixel_width = params->map.cols * MAP_SCALE;
-  int map_pixel_height = params->map.rows * MAP_SCALE;
-  int max_draw_x = (map_pixel_width < params->window_img.width)
-                       ? map_pixel_width
-                       : params->window_img.width;
-  int max_draw_y = (map_pixel_height < params->window_img.height)
-                       ? map_pixel_height
-                       : params->window_img.height;
-
-  for (y = 0; y < params->map.rows; y++) {
-    draw_y_base = y * MAP_SCALE;
-    if (draw_y_base >= max_draw_y)
-      break;
-
-    for (x = 0; x < params->map.cols; x++) {
-      draw_x_base = x * MAP_SCALE;
-      if (draw_x_base >= max_draw_x)
-        break;
-
-      color = (params->map.map_data[y][x] == WALL) ? C_GRAY : C_DARK_GRAY;
-
-      for (tile_y = 0; tile_y < MAP_SCALE - 1; tile_y++) {
-        int py = draw_y_base + tile_y;
-        if (py >= max_draw_y)
-          break;
-
-        for (tile_x = 0; tile_x < MAP_SCALE - 1; tile_x++) {
-          int px = draw_x_base + tile_x;
-          if (px >= max_draw_x)
-            break;
-          put_pixel_direct(&params->window_img, px, py, color);
-        }
-      }
-    }
-  }
-}
-
-void draw_player(t_params *params) {
-  int player_marker_size = 4;
-  int player_screen_x = (int)(params->player.x / TILE_SIZE * MAP_SCALE);
-  int player_screen_y = (int)(params->player.y / TILE_SIZE * MAP_SCALE);
-  int i, j, px, py;
-
-  for (i = -player_marker_size / 2; i <= player_marker_size / 2; i++) {
-    for (j = -player_marker_size / 2; j <= player_marker_size / 2; j++) {
-      px = player_screen_x + i;
-      py = player_screen_y + j;
-      put_pixel_direct(&params->window_img, px, py, C_RED);
-    }
-  }
-
-  t_point p1 = {player_screen_x, player_screen_y};
-  t_point p2 = {
-      player_screen_x + (int)(cos(params->player.direction) * MAP_SCALE * 1.5),
-      player_screen_y + (int)(sin(params->player.direction) * MAP_SCALE * 1.5)};
-  draw_line_img(params, p1, p2, C_RED);
-}
-
-void cast_rays(t_params *params, t_ray_hit *ray_hits) {
-  double ray_angle, angle_step;
-  int i;
-  t_fpoint h_intersect, v_intersect;
-  double h_dist_sq, v_dist_sq;
-
-  angle_step = PLAYER_FOV / (double)NUM_RAYS;
-  ray_angle = params->player.direction - (PLAYER_FOV / 2.0);
-
-  for (i = 0; i < NUM_RAYS; i++) {
-    ray_angle = normalize_angle(ray_angle);
-    h_intersect = find_horizontal_wall_intersection(params, ray_angle);
-    v_intersect = find_vertical_wall_intersection(params, ray_angle);
-
-    h_dist_sq = (h_intersect.x != INT_MAX)
-                    ? pow(h_intersect.x - params->player.x, 2) +
-                          pow(h_intersect.y - params->player.y, 2)
-                    : __DBL_MAX__;
-    v_dist_sq = (v_intersect.x != INT_MAX)
-                    ? pow(v_intersect.x - params->player.x, 2) +
-                          pow(v_intersect.y - params->player.y, 2)
-                    : __DBL_MAX__;
-
-    if (h_dist_sq < v_dist_sq) {
-      ray_hits[i].distance = sqrt(h_dist_sq);
-      ray_hits[i].hit_point = h_intersect;
-      ray_hits[i].is_vertical = false;
-    } else {
-      ray_hits[i].distance = sqrt(v_dist_sq);
-      ray_hits[i].hit_point = v_intersect;
-      ray_hits[i].is_vertical = true;
-    }
-
-    ray_hits[i].distance *=
-        cos(ray_angle - params->player.direction); // Fisheye correction
-    ray_hits[i].ray_angle = ray_angle;
-
-    if (ray_hits[i].distance < __DBL_MAX__) {
-      double check_x = ray_hits[i].hit_point.x;
-      double check_y = ray_hits[i].hit_point.y;
-      if (ray_hits[i].is_vertical) {
-        check_x += (cos(ray_angle) > 0 ? -0.01 : 0.01);
-      } else {
-        check_y += (sin(ray_angle) > 0 ? -0.01 : 0.01);
-      }
-      ray_hits[i].map_x = (int)(check_x / TILE_SIZE);
-      ray_hits[i].map_y = (int)(check_y / TILE_SIZE);
-    } else {
-      ray_hits[i].map_x = -1;
-      ray_hits[i].map_y = -1;
-    }
-    ray_angle += angle_step;
-  }
-}
-
-void draw_rays_minimap(t_params *params, t_ray_hit *ray_hits) {
-  int i;
-  t_point p1, p2;
-
-  p1.x = (int)(params->player.x / TILE_SIZE * MAP_SCALE);
-  p1.y = (int)(params->player.y / TILE_SIZE * MAP_SCALE);
-
-  for (i = 0; i < NUM_RAYS; i += MINIMAP_RAY_STEP) {
-    if (ray_hits[i].distance < MAX_VISIBLE_DISTANCE &&
-        ray_hits[i].distance > 0.01) {
-      p2.x = (int)(ray_hits[i].hit_point.x / TILE_SIZE * MAP_SCALE);
-      p2.y = (int)(ray_hits[i].hit_point.y / TILE_SIZE * MAP_SCALE);
-      draw_line_img(params, p1, p2, C_YELLOW);
-    }
-  }
-}
-
-void draw_vertical_slice_direct(t_params *params, int x, int y_start, int y_end,
-                                int base_color, double distance) {
-  int y, shaded_color;
-  char *pixel_addr;
-  int pixel_bytes = params->window_img.bpp;
-
-  if (x < 0 || x >= params->window_img.width)
-    return;
-  int clamped_y_start = (y_start < 0) ? 0 : y_start;
-  int clamped_y_end = (y_end >= params->window_img.height)
-                          ? params->window_img.height - 1
-                          : y_end;
-
-  if (clamped_y_start > clamped_y_end)
-    return; // Nothing to draw
-
-  shaded_color = apply_shading(base_color, distance);
-  pixel_addr = params->window_img.addr +
-               (clamped_y_start * params->window_img.line_length) +
-               (x * pixel_bytes);
-
-  for (y = clamped_y_start; y <= clamped_y_end; y++) {
-    *(unsigned int *)pixel_addr = shaded_color;
-    pixel_addr += params->window_img.line_length;
-  }
-}
-
-void render_3d_view(t_params *params, t_ray_hit *ray_hits) {
-  int i, draw_start, draw_end, wall_color;
-  double slice_height, perp_distance;
-
-  for (i = 0; i < NUM_RAYS; i++) {
-    perp_distance = ray_hits[i].distance;
-
-    if (perp_distance < MAX_VISIBLE_DISTANCE && perp_distance > 0.01) {
-      slice_height = (TILE_SIZE / perp_distance) * params->dist_proj_plane;
-      draw_start = (params->window_img.height / 2) - ((int)slice_height / 2);
-      draw_end = draw_start + (int)slice_height;
-
-      wall_color =
-          ray_hits[i].is_vertical ? C_GREEN : C_BLUE; // Example coloring
-
-      draw_vertical_slice_direct(params, i, 0, draw_start - 1, C_CEILING,
-                                 MAX_VISIBLE_DISTANCE);
-      draw_vertical_slice_direct(params, i, draw_start, draw_end, wall_color,
-                                 perp_distance);
-      draw_vertical_slice_direct(params, i, draw_end + 1,
-                                 params->window_img.height - 1, C_FLOOR,
-                                 MAX_VISIBLE_DISTANCE);
-    } else {
-      draw_vertical_slice_direct(params, i, 0,
-                                 params->window_img.height / 2 - 1, C_CEILING,
-                                 MAX_VISIBLE_DISTANCE);
-      draw_vertical_slice_direct(params, i, params->window_img.height / 2,
-                                 params->window_img.height - 1, C_FLOOR,
-                                 MAX_VISIBLE_DISTANCE);
-    }
-  }
-}
 
 // --- Game Logic and Hooks ---
 
 int game_loop(t_params *params) {
-  static t_ray_hit ray_hits[NUM_RAYS];
-  static long last_frame_time = 0;
+  bool fast = params->replay.mode == REPLAY_PLAY && params->replay.fast;
+  long now_us;
 
-  clear_image_direct(params, C_BLACK);
-  cast_rays(params, ray_hits);
-  render_3d_view(params, ray_hits);
-
-#ifdef DRAW_MINIMAP // Compile with -D DRAW_MINIMAP to enable
-  draw_map(params);
-  draw_rays_minimap(params, ray_hits);
-  draw_player(params);
-#endif
+  if (replay_done(params))
+    close_window_hook(params);
+  now_us = fast ? replay_clock(params) : get_time_us();
+  PROF_BEGIN(PROF_SIM);
+  world_lock(params);
+  sim_update(params, now_us);
+  world_unlock(params);
+  PROF_END(PROF_SIM);
+#ifdef PRESENT_THREAD // Rendering happens on the render thread
+  PROF_BEGIN(PROF_PRESENT);
+  present_frame(params);
+  PROF_END(PROF_PRESENT);
+#else
+  static t_ray_hit ray_hits[NUM_RAYS];
 
+  render_interpolated(params, ray_hits, now_us);
+  PROF_BEGIN(PROF_PRESENT);
   mlx_put_image_to_window(params->mlx, params->win, params->window_img.img, 0,
                           0);
-  frame_rate_control(&last_frame_time, FRAME_RATE_CAP);
+  PROF_END(PROF_PRESENT);
+#endif
+  PROF_BEGIN(PROF_SLEEP);
+  if (!fast)
+    pacer_wait(&params->pacer);
+  PROF_END(PROF_SLEEP);
+  PROF_TRACE_FLUSH(false);
 
   return 0;
 }
 
 int key_press_hook(int keycode, t_params *params) {
-  double move_step = MOVE_SPEED; // Assumes MOVE_SPEED is defined appropriately
-  double rot_step =
-      ROTATE_SPEED; // Assumes ROTATE_SPEED is defined appropriately
-  double new_x = params->player.x;
-  double new_y = params->player.y;
-  double dir_x = cos(params->player.direction);
-  double dir_y = sin(params->player.direction);
-  double side_x = -dir_y;
-  double side_y = dir_x;
-  double collision_dist = TILE_SIZE * 0.25;
-  double move_x_comp = 0.0;
-  double move_y_comp = 0.0;
-
   if (keycode == XK_Escape) {
     close_window_hook(params);
     return 0;
   }
 
-  if (keycode == XK_Left) {
-    params->player.direction -= rot_step;
-  } else if (keycode == XK_Right) {
-    params->player.direction += rot_step;
+  world_lock(params); // The render thread may be copying the world
+  if (params->replay.mode != REPLAY_PLAY) { // A replay owns the input
+    replay_record_key(params, keycode, true);
+    input_key(params, keycode, true);
   }
+  world_unlock(params);
+  return 0;
+}
 
-  params->player.direction = normalize_angle(params->player.direction);
-  dir_x = cos(params->player.direction); // Update after rotation
-  dir_y = sin(params->player.direction);
-  side_x = -dir_y;
-  side_y = dir_x;
-
-  if (keycode == XK_w || keycode == XK_Up) {
-    move_x_comp += dir_x * move_step;
-    move_y_comp += dir_y * move_step;
-  } else if (keycode == XK_s || keycode == XK_Down) {
-    move_x_comp -= dir_x * move_step;
-    move_y_comp -= dir_y * move_step;
-  } else if (keycode == XK_a) {
-    move_x_comp += side_x * move_step;
-    move_y_comp += side_y * move_step;
-  } else if (keycode == XK_d) {
-    move_x_comp -= side_x * move_step;
-    move_y_comp -= side_y * move_step;
-  }
-
-  if (move_x_comp != 0.0 || move_y_comp != 0.0) {
-    double check_x = params->player.x + move_x_comp;
-    double collision_check_x =
-        check_x + (move_x_comp > 0 ? collision_dist : -collision_dist);
-    if (!is_wall_at(params, collision_check_x, params->player.y)) {
-      new_x = check_x;
-    }
-
-    double check_y = params->player.y + move_y_comp;
-    double collision_check_y =
-        check_y + (move_y_comp > 0 ? collision_dist : -collision_dist);
-    if (!is_wall_at(
-            params, new_x,
-            collision_check_y)) { // Check using potentially updated new_x
-      new_y = check_y;
-    }
-
-    params->player.x = new_x;
-    params->player.y = new_y;
+int key_release_hook(int keycode, t_params *params) {
+  world_lock(params);
+  if (params->replay.mode != REPLAY_PLAY) {
+    replay_record_key(params, keycode, false);
+    input_key(params, keycode, false);
   }
+  world_unlock(params);
   return 0;
 }
 
@@ -464,17 +90,15 @@ int close_window_hook(t_params *params) {
 }
 
 void cleanup(t_params *params) {
-  int i = 0;
-
-  if (params->map.map_data) {
-    for (i = 0; i < params->map.rows; i++) {
-      if (params->map.map_data[i]) {
-        free(params->map.map_data[i]);
-      }
-    }
-    free(params->map.map_data);
-    params->map.map_data = NULL;
-  }
+  if (params->mlx)
+    present_shutdown(params); // Joins the render thread before freeing
+  pacer_report(&params->pacer);
+  PROF_REPORT(stderr);
+  PROF_TRACE_FLUSH(true);
+  COUNT_CLOSE();
+  sim_report(params);
+  replay_close(params);
+  world_free(params);
 
   if (params->mlx) {
     if (params->window_img.img)
@@ -489,105 +113,25 @@ void cleanup(t_params *params) {
 }
 
 void init_params(t_params *params) {
-  const char *map_layout[] = {
+  static const char *const map_layout[] = {
       // Example map
-      "1111111111111111111111111", "1000000001000000000000101",
-      "1011010111011001011101101", "1001000000010001000100001",
-      "10110111110110W0011101001", "1000000010000000000000001",
+      "1111111111111111111111111", "1000200001000002000000101",
+      "1011D10111011001011101101", "1001002000010001000100001",
+      "1011011111D110W0011101001", "1002000010000000000200001",
       "1001000010000111111000101", "1010001010000000001000101",
       "1111111111111111111111111"};
-  int rows = sizeof(map_layout) / sizeof(map_layout[0]);
-  int cols = 0;
-  int x, y;
-  bool player_found = false;
 
   ft_memset(params, 0, sizeof(t_params)); // Use ft_memset if available
-
-  if (rows > 0)
-    cols = ft_strlen(map_layout[0]); // Use ft_strlen if available
-
-  params->map.rows = rows;
-  params->map.cols = cols;
-  if (rows < 3 || cols < 3) {
-    fprintf(stderr, "Error: Map is too small.\n");
-    exit(EXIT_FAILURE);
-  }
-  params->map.map_data = malloc(rows * sizeof(char *));
-  if (!params->map.map_data) {
-    perror("Error allocating map rows");
-    exit(EXIT_FAILURE);
-  }
-
-  for (y = 0; y < rows; y++) {
-    if (ft_strlen(map_layout[y]) != cols) { // Use ft_strlen
-      fprintf(stderr, "Error: Map row %d has inconsistent length.\n", y);
-      while (--y >= 0)
-        free(params->map.map_data[y]);
-      free(params->map.map_data);
-      exit(EXIT_FAILURE);
-    }
-    params->map.map_data[y] = ft_strdup(map_layout[y]); // Use ft_strdup
-    if (!params->map.map_data[y]) {
-      perror("Error allocating map row");
-      while (--y >= 0)
-        free(params->map.map_data[y]);
-      free(params->map.map_data);
-      exit(EXIT_FAILURE);
-    }
-
-    for (x = 0; x < cols; x++) {
-      char cell = params->map.map_data[y][x];
-      if (strchr("01NSEW ", cell) == NULL) { // Allow space?
-        fprintf(stderr, "Error: Invalid map character '%c' at (%d, %d).\n",
-                cell, x, y);
-        cleanup(params);
-        exit(EXIT_FAILURE);
-      }
-      if (!player_found && strchr("NSEW", cell)) {
-        params->player.x = (x + 0.5) * TILE_SIZE;
-        params->player.y = (y + 0.5) * TILE_SIZE;
-        if (cell == PLAYER_NORTH)
-          params->player.direction = 3.0 * M_PI / 2.0;
-        else if (cell == PLAYER_SOUTH)
-          params->player.direction = M_PI / 2.0;
-        else if (cell == PLAYER_EAST)
-          params->player.direction = 0.0;
-        else if (cell == PLAYER_WEST)
-          params->player.direction = M_PI;
-        params->map.map_data[y][x] = EMPTY;
-        player_found = true;
-      } else if (player_found && strchr("NSEW", cell)) {
-        fprintf(stderr, "Error: Multiple player start positions.\n");
-        cleanup(params);
-        exit(EXIT_FAILURE);
-      }
-    }
-  }
-
-  if (!player_found) {
-    fprintf(stderr, "Error: No player start position found.\n");
+  if (world_load(params, map_layout,
+                 sizeof(map_layout) / sizeof(map_layout[0])) != 0) {
     cleanup(params);
     exit(EXIT_FAILURE);
   }
+  pacer_init(&params->pacer, FRAME_RATE_CAP, PACER_SPIN_NS);
+}
 
-  for (x = 0; x < cols; x++)
-    if (params->map.map_data[0][x] != WALL ||
-        params->map.map_data[rows - 1][x] != WALL)
-      goto map_error;
-  for (y = 0; y < rows; y++)
-    if (params->map.map_data[y][0] != WALL ||
-        params->map.map_data[y][cols - 1] != WALL)
-      goto map_error;
-  goto map_ok;
-map_error:
-  fprintf(stderr, "Error: Map must be enclosed by walls ('1').\n");
-  cleanup(params);
-  exit(EXIT_FAILURE);
-map_ok:;
-
-  params->player.fov = PLAYER_FOV;
-  params->dist_proj_plane = (WINDOW_WIDTH / 2.0) / tan(PLAYER_FOV / 2.0);
-
+// Opens the window and its image, and sets up presentation.
+void init_window(t_params *params) {
   params->mlx = mlx_init();
   if (!params->mlx) {
     perror("mlx_init failed");
@@ -624,18 +168,142 @@ map_ok:;
     fprintf(stderr, "Warning: Code optimized for 32bpp. Current bpp: %d\n",
             params->window_img.bpp * 8);
   }
+#ifdef PRESENT_THREAD
+  if (present_init(params) != 0) {
+    perror("present_init failed");
+    cleanup(params);
+    exit(EXIT_FAILURE);
+  }
+#endif
+}
+
+static void usage_error(const char *arg) {
+  fprintf(stderr,
+          "Error: Unknown argument %s\n"
+          "Usage: ./cub3D [--headless[=FRAMES]] [--record=FILE] "
+          "[--replay=FILE [--replay-fast]] [--trace[=FILE]] "
+          "[--trace-frames=FIRST,COUNT] [--perf] [--counters[=FILE]]\n",
+          arg);
+  exit(EXIT_FAILURE);
 }
 
-int main(void) {
+/**
+ * Parses the command line. --headless renders FRAMES frames along a
+ * scripted path, or the --replay, without a window and prints the
+ * timings as JSON. --record logs the keys of a windowed run to FILE and
+ * --replay plays them back in real time, or as fast as frames can be
+ * drawn with --replay-fast.
+ * --trace writes a Chrome trace of frames FIRST to FIRST + COUNT - 1,
+ * counted from 1, to FILE; profile builds also trace the next frames
+ * whenever the process gets SIGUSR1. --perf adds perf_event counters
+ * to the profile. --counters writes the hot-path counters of every
+ * frame to FILE as CSV.
+ */
+static void parse_args(int argc, char **argv, t_options *opts) {
+  const char *trace_path = NULL, *count_path = NULL;
+  bool trace = false, counters = false, perf = false;
+  int first = 1, count = TRACE_DEFAULT_FRAMES, i;
+
+  ft_memset(opts, 0, sizeof(*opts));
+  opts->headless_frames = HEADLESS_DEFAULT_FRAMES;
+  for (i = 1; i < argc; i++) {
+    if (ft_strcmp(argv[i], "--headless") == 0)
+      opts->headless = true;
+    else if (ft_strncmp(argv[i], "--headless=", 11) == 0 &&
+             ft_atoi(argv[i] + 11) > 0) {
+      opts->headless = true;
+      opts->headless_frames = ft_atoi(argv[i] + 11);
+    } else if (ft_strncmp(argv[i], "--record=", 9) == 0 && argv[i][9])
+      opts->record_path = argv[i] + 9;
+    else if (ft_strncmp(argv[i], "--replay=", 9) == 0 && argv[i][9])
+      opts->replay_path = argv[i] + 9;
+    else if (ft_strcmp(argv[i], "--replay-fast") == 0)
+      opts->replay_fast = true;
+    else if (ft_strcmp(argv[i], "--trace") == 0)
+      trace = true;
+    else if (ft_strncmp(argv[i], "--trace=", 8) == 0) {
+      trace = true;
+      trace_path = argv[i] + 8;
+    } else if (ft_strncmp(argv[i], "--trace-frames=", 15) == 0 &&
+               ft_strchr(argv[i], ',')) {
+      first = ft_atoi(argv[i] + 15);
+      count = ft_atoi(ft_strchr(argv[i], ',') + 1);
+    } else if (ft_strcmp(argv[i], "--perf") == 0)
+      perf = true;
+    else if (ft_strcmp(argv[i], "--counters") == 0)
+      counters = true;
+    else if (ft_strncmp(argv[i], "--counters=", 11) == 0) {
+      counters = true;
+      count_path = argv[i] + 11;
+    } else
+      usage_error(argv[i]);
+  }
+#ifdef COUNTERS
+  if (counters && count_open(count_path) != 0)
+    perror(count_path ? count_path : COUNT_DEFAULT_PATH);
+#else
+  (void)count_path;
+  if (counters)
+    fprintf(stderr, "--counters ignored: build with make counters\n");
+#endif
+#ifdef PROFILE
+  if (prof_trace_init(trace_path, trace ? first : -1, count) != 0)
+    perror("prof_trace_init failed");
+  if (perf)
+    prof_perf_init(); // Prints why on failure; timing still works
+#else
+  (void)trace_path;
+  (void)first;
+  (void)count;
+  if (trace || perf)
+    fprintf(stderr, "--trace and --perf ignored: build with make profile\n");
+#endif
+}
+
+int main(int argc, char **argv) {
   t_params params;
+  t_options opts;
+  int status;
 
+  parse_args(argc, argv, &opts);
+  PROF_THREAD("main");
   init_params(&params);
+  if (opts.record_path && (opts.headless || opts.replay_path)) {
+    fprintf(stderr, "Error: --record needs a window and live input\n");
+    cleanup(&params);
+    return (EXIT_FAILURE);
+  }
+  if ((opts.replay_path &&
+       replay_load(&params, opts.replay_path, opts.replay_fast) != 0) ||
+      (opts.record_path &&
+       replay_record_open(&params, opts.record_path) != 0)) {
+    if (opts.record_path)
+      perror(opts.record_path);
+    cleanup(&params);
+    return (EXIT_FAILURE);
+  }
+  if (opts.headless) {
+    status = headless_run(&params, opts.headless_frames, stdout);
+    if (status != 0)
+      perror("headless_run failed");
+    cleanup(&params);
+    return (status == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+  init_window(&params);
 
   mlx_loop_hook(params.mlx, game_loop, &params);
   mlx_hook(params.win, KeyPress, KeyPressMask, key_press_hook, &params);
+  mlx_hook(params.win, KeyRelease, KeyReleaseMask, key_release_hook, &params);
   mlx_hook(params.win, DestroyNotify, StructureNotifyMask, close_window_hook,
            &params);
 
+#ifdef PRESENT_THREAD
+  if (present_start(&params) != 0) {
+    perror("Failed to start render thread");
+    cleanup(&params);
+    return (EXIT_FAILURE);
+  }
+#endif
   mlx_loop(params.mlx);
 
   // Cleanup is handled by close_window_hook or exit in init_params on error
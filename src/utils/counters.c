@@ -0,0 +1,129 @@
+#include "../../include/cub3d.h"
+
+#ifdef COUNTERS
+
+// --- Hot-Path Counters ---
+
+t_counters g_counters = {.frame = {.steps_min = UINT_MAX},
+                         .total = {.steps_min = UINT_MAX}};
+
+/**
+ * Writes a row per frame to path from the next frame on.
+ *
+ * @return 0 on success, -1 with errno set if the file cannot be written
+ */
+int count_open(const char *path) {
+  int i;
+
+  g_counters.csv = fopen(path ? path : COUNT_DEFAULT_PATH, "w");
+  if (!g_counters.csv)
+    return -1;
+  fprintf(g_counters.csv, "frame,rays,steps,steps_min,steps_avg,steps_max,"
+                          "view_pixels,texels,minimap_pixels");
+  for (i = 0; i < COUNT_HIST_BUCKETS; i++)
+    fprintf(g_counters.csv, ",steps_%u", (i == 0) ? 0 : 1u << (i - 1));
+  fputc('\n', g_counters.csv);
+  return 0;
+}
+
+static int hist_bucket(unsigned int steps) {
+  int bucket = 0;
+
+  while (steps && bucket < COUNT_HIST_BUCKETS - 1) {
+    steps >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+// Ends the current ray: folds its steps into the frame.
+void count_ray(void) {
+  t_count_frame *f = &g_counters.frame;
+  unsigned int steps = g_counters.ray_steps;
+
+  f->rays++;
+  f->steps += steps;
+  f->steps_min = (steps < f->steps_min) ? steps : f->steps_min;
+  f->steps_max = (steps > f->steps_max) ? steps : f->steps_max;
+  f->hist[hist_bucket(steps)]++;
+  g_counters.ray_steps = 0;
+}
+
+static void write_row(const t_count_frame *f) {
+  int i;
+
+  fprintf(g_counters.csv, "%lu,%lu,%lu,%u,%.2f,%u,%lu,%lu,%lu",
+          g_counters.frames, f->rays, f->steps, f->rays ? f->steps_min : 0,
+          f->rays ? (double)f->steps / f->rays : 0.0, f->steps_max,
+          f->view_pixels, f->texels, f->minimap_pixels);
+  for (i = 0; i < COUNT_HIST_BUCKETS; i++)
+    fprintf(g_counters.csv, ",%lu", f->hist[i]);
+  fputc('\n', g_counters.csv);
+}
+
+// Closes the frame drawn since the last call, if anything was drawn.
+void count_frame(void) {
+  t_count_frame *f = &g_counters.frame, *t = &g_counters.total;
+  int i;
+
+  if (f->rays == 0 && f->view_pixels == 0 && f->minimap_pixels == 0)
+    return;
+  g_counters.frames++;
+  if (g_counters.csv)
+    write_row(f);
+  t->rays += f->rays;
+  t->steps += f->steps;
+  t->steps_min = (f->steps_min < t->steps_min) ? f->steps_min : t->steps_min;
+  t->steps_max = (f->steps_max > t->steps_max) ? f->steps_max : t->steps_max;
+  for (i = 0; i < COUNT_HIST_BUCKETS; i++)
+    t->hist[i] += f->hist[i];
+  t->view_pixels += f->view_pixels;
+  t->texels += f->texels;
+  t->minimap_pixels += f->minimap_pixels;
+  ft_memset(f, 0, sizeof(*f));
+  f->steps_min = UINT_MAX;
+}
+
+/**
+ * Prints per-frame averages and the steps-per-ray histogram of the run.
+ * Call when no frame is being drawn.
+ */
+void count_report(FILE *out) {
+  const t_count_frame *t = &g_counters.total;
+  unsigned long n;
+  int i;
+
+  count_frame();
+  n = g_counters.frames;
+  if (n == 0 || t->rays == 0)
+    return;
+  fprintf(out,
+          "counters: %lu frames, per frame %.0f rays, %.0f grid steps, "
+          "%.0f view pixels, %.0f texels, %.0f minimap pixels\n"
+          "  steps/ray min %u avg %.2f max %u\n",
+          n, (double)t->rays / n, (double)t->steps / n,
+          (double)t->view_pixels / n, (double)t->texels / n,
+          (double)t->minimap_pixels / n, t->steps_min,
+          (double)t->steps / t->rays, t->steps_max);
+  for (i = 0; i < COUNT_HIST_BUCKETS; i++) {
+    if (t->hist[i] == 0)
+      continue;
+    if (i == 0)
+      fprintf(out, "  %5u        ", 0);
+    else if (i == COUNT_HIST_BUCKETS - 1)
+      fprintf(out, "  %5u+       ", 1u << (i - 1));
+    else
+      fprintf(out, "  %5u..%-5u ", 1u << (i - 1), (1u << i) - 1);
+    fprintf(out, "%6.2f%%\n", 100.0 * t->hist[i] / t->rays);
+  }
+}
+
+// Reports the run and closes the CSV file.
+void count_close(void) {
+  count_report(stderr);
+  if (g_counters.csv && fclose(g_counters.csv) != 0)
+    perror("counters");
+  g_counters.csv = NULL;
+}
+
+#endif
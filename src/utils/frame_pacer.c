@@ -0,0 +1,68 @@
+#include "../../include/cub3d.h"
+#include <time.h>
+
+// --- Frame Pacer ---
+//
+// Paces the game loop against absolute CLOCK_MONOTONIC deadlines spaced by
+// one period, so sleep error never accumulates into drift. clock_nanosleep
+// wakes with a few tens of microseconds of jitter; with a spin tail it is
+// asked to wake spin_ns early and the rest is busy-waited. A frame that
+// reaches pacer_wait after its deadline counts as missed and the schedule
+// restarts from now instead of rushing to catch up.
+
+void pacer_init(t_pacer *pacer, int hz, long spin_ns) {
+  ft_memset(pacer, 0, sizeof(*pacer));
+  pacer->period_ns = (hz > 0) ? 1000000000L / hz : 0;
+  pacer->spin_ns = spin_ns;
+}
+
+static void sleep_until(long deadline_ns) {
+  struct timespec ts;
+
+  ts.tv_sec = deadline_ns / 1000000000L;
+  ts.tv_nsec = deadline_ns % 1000000000L;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+    ;
+}
+
+/**
+ * Waits for the end of the current frame period. Returns immediately,
+ * counting a missed deadline, if the frame already overran it.
+ */
+void pacer_wait(t_pacer *pacer) {
+  t_pacer_stats *s = &pacer->stats;
+  long now = get_time_ns(), late;
+
+  if (pacer->period_ns <= 0)
+    return;
+  if (pacer->deadline_ns == 0)
+    pacer->deadline_ns = now;
+  pacer->deadline_ns += pacer->period_ns;
+  s->frames++;
+  if (now >= pacer->deadline_ns) {
+    s->missed++;
+    pacer->deadline_ns = now;
+    return;
+  }
+  if (pacer->deadline_ns - now > pacer->spin_ns)
+    sleep_until(pacer->deadline_ns - pacer->spin_ns);
+  while ((now = get_time_ns()) < pacer->deadline_ns)
+    ;
+  late = now - pacer->deadline_ns;
+  s->late_ns_total += late;
+  s->late_ns_max = (late > s->late_ns_max) ? late : s->late_ns_max;
+}
+
+void pacer_report(t_pacer *pacer) {
+  t_pacer_stats *s = &pacer->stats;
+  unsigned long met = s->frames - s->missed;
+
+  if (s->frames == 0)
+    return;
+  fprintf(stderr,
+          "pacer: %.1f Hz target, %lu of %lu deadlines missed (%.2f%%), "
+          "wake-up %.1f us late avg / %.1f us max\n",
+          1e9 / pacer->period_ns, s->missed, s->frames,
+          100.0 * s->missed / s->frames,
+          met ? s->late_ns_total / 1000.0 / met : 0.0, s->late_ns_max / 1000.0);
+}
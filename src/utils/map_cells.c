@@ -0,0 +1,251 @@
+#include "../../include/cub3d.h"
+
+// --- Dynamic Cells ---
+//
+// map_data stays the single source of truth for cell types. Doors keep
+// their animation state in params->doors, indexed per cell through
+// cell_door so the ray traversal can find a door in O(1). Every runtime
+// change goes through cell_set, which patches only the derived data of
+// the touched cell: the door table, the minimap occupancy pyramid and
+// the lightmap around it.
+// All functions here expect the caller to hold world_lock.
+
+static t_door *door_at_index(t_params *params, int x, int y) {
+  int idx = params->doors.cell_door[y * params->map.cols + x];
+
+  return (idx < 0) ? NULL : &params->doors.items[idx];
+}
+
+static bool in_map(t_params *params, int x, int y) {
+  return x >= 0 && y >= 0 && x < params->map.cols && y < params->map.rows;
+}
+
+t_door *door_at(t_params *params, int x, int y) {
+  if (!params->doors.cell_door || !in_map(params, x, y))
+    return NULL;
+  return door_at_index(params, x, y);
+}
+
+// Doors slide along the wall pair they sit between.
+static bool is_vertical_door(t_params *params, int x, int y) {
+  char **m = params->map.map_data;
+
+  if (m[y][x - 1] == WALL && m[y][x + 1] == WALL)
+    return false;
+  return m[y - 1][x] == WALL && m[y + 1][x] == WALL;
+}
+
+static int add_door(t_params *params, int x, int y) {
+  t_doors *d = &params->doors;
+  t_door *items;
+  int capacity;
+
+  if (d->count == d->capacity) {
+    capacity = d->capacity ? d->capacity * 2 : 8;
+    items = realloc(d->items, capacity * sizeof(*items));
+    if (!items)
+      return -1;
+    d->items = items;
+    d->capacity = capacity;
+  }
+  d->items[d->count] =
+      (t_door){x, y, is_vertical_door(params, x, y), 0.0, 0.0};
+  d->cell_door[y * params->map.cols + x] = d->count++;
+  return 0;
+}
+
+static void remove_door(t_params *params, int x, int y) {
+  t_doors *d = &params->doors;
+  int idx = d->cell_door[y * params->map.cols + x];
+  t_door *last;
+
+  if (idx < 0)
+    return;
+  last = &d->items[--d->count];
+  d->items[idx] = *last;
+  d->cell_door[last->y * params->map.cols + last->x] = idx;
+  d->cell_door[y * params->map.cols + x] = -1;
+}
+
+/**
+ * Builds the per-cell door index and registers the doors of the map.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int cells_init(t_params *params) {
+  t_doors *d = &params->doors;
+  int x, y, cells = params->map.rows * params->map.cols;
+
+  d->cell_door = malloc(cells * sizeof(int));
+  if (!d->cell_door)
+    return -1;
+  for (x = 0; x < cells; x++)
+    d->cell_door[x] = -1;
+  for (y = 0; y < params->map.rows; y++)
+    for (x = 0; x < params->map.cols; x++)
+      if (params->map.map_data[y][x] == DOOR && add_door(params, x, y) != 0)
+        return -1;
+  d->last_update_us = params->sim.time_us; // Doors run on simulated time
+  return 0;
+}
+
+void cells_free(t_params *params) {
+  free(params->doors.items);
+  free(params->doors.cell_door);
+  params->doors.items = NULL;
+  params->doors.cell_door = NULL;
+  params->doors.count = 0;
+  params->doors.capacity = 0;
+}
+
+/**
+ * Occupancy of a cell from 0 (free) to 255 (solid), as shown by the
+ * minimap. Doors fade out as they open.
+ */
+unsigned char cell_occupancy(t_params *params, int x, int y) {
+  char cell = params->map.map_data[y][x];
+  t_door *door;
+
+  if (cell == WALL)
+    return 255;
+  if (cell != DOOR || !(door = door_at(params, x, y)))
+    return (cell == DOOR) ? 255 : 0;
+  return (unsigned char)(255.0 * (1.0 - door->open));
+}
+
+// Blocks movement unless empty or a fully open door.
+bool cell_is_solid(t_params *params, int x, int y) {
+  t_door *door;
+
+  if (!in_map(params, x, y))
+    return true;
+  if (params->map.map_data[y][x] == WALL)
+    return true;
+  if (params->map.map_data[y][x] != DOOR)
+    return false;
+  door = door_at(params, x, y);
+  return !door || door->open < 1.0;
+}
+
+static bool player_in_cell(t_params *params, int x, int y) {
+  return (int)(params->player.x / TILE_SIZE) == x &&
+         (int)(params->player.y / TILE_SIZE) == y;
+}
+
+/**
+ * Changes cell (x, y) to EMPTY, WALL or DOOR (created closed) and patches
+ * the derived data. Border cells stay walls so the map remains enclosed,
+ * and the player's cell cannot become solid.
+ *
+ * @return 0 on success, -1 if the change is not allowed or out of memory
+ */
+int cell_set(t_params *params, int x, int y, char value) {
+  char *cell;
+
+  if (!in_map(params, x, y) || x == 0 || y == 0 ||
+      x == params->map.cols - 1 || y == params->map.rows - 1)
+    return -1;
+  if (value != EMPTY && value != WALL && value != DOOR)
+    return -1;
+  if (value != EMPTY && player_in_cell(params, x, y))
+    return -1;
+  cell = &params->map.map_data[y][x];
+  if (*cell == value)
+    return 0;
+  if (*cell == DOOR)
+    remove_door(params, x, y);
+  *cell = value;
+  if (value == DOOR && add_door(params, x, y) != 0) {
+    *cell = EMPTY;
+    minimap_invalidate_cell(params, x, y);
+    return -1;
+  }
+  minimap_invalidate_cell(params, x, y);
+  lighting_relight_cell(params, x, y);
+  interlace_invalidate(params);
+  return 0;
+}
+
+/**
+ * Pushes the wall at from into the empty cell to.
+ *
+ * @return 0 on success, -1 if from is not a wall or to is not empty
+ */
+int cell_move_wall(t_params *params, t_point from, t_point to) {
+  if (!in_map(params, from.x, from.y) || !in_map(params, to.x, to.y) ||
+      params->map.map_data[from.y][from.x] != WALL ||
+      params->map.map_data[to.y][to.x] != EMPTY)
+    return -1;
+  if (cell_set(params, to.x, to.y, WALL) != 0)
+    return -1;
+  if (cell_set(params, from.x, from.y, EMPTY) != 0) {
+    cell_set(params, to.x, to.y, EMPTY);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Starts opening a closed or closing door, or closing an open one. A door
+ * does not close on the player.
+ *
+ * @return true if the door at (x, y) started moving
+ */
+bool door_toggle(t_params *params, int x, int y) {
+  t_door *door = door_at(params, x, y);
+
+  if (!door)
+    return false;
+  if (door->speed > 0.0 || (door->speed == 0.0 && door->open >= 1.0)) {
+    if (player_in_cell(params, x, y))
+      return false;
+    door->speed = -1.0 / DOOR_SLIDE_SECONDS;
+  } else
+    door->speed = 1.0 / DOOR_SLIDE_SECONDS;
+  return true;
+}
+
+// Advances the sliding doors to now_us.
+void doors_update(t_params *params, long now_us) {
+  t_doors *d = &params->doors;
+  double dt = (now_us - d->last_update_us) / 1e6;
+  t_door *door;
+  bool was_open;
+  int i;
+
+  d->last_update_us = now_us;
+  for (i = 0; i < d->count; i++) {
+    door = &d->items[i];
+    if (door->speed == 0.0)
+      continue;
+    was_open = door->open >= 1.0;
+    door->open += door->speed * dt;
+    if (door->open <= 0.0 || door->open >= 1.0) {
+      door->open = (door->open <= 0.0) ? 0.0 : 1.0;
+      door->speed = 0.0;
+    }
+    minimap_invalidate_cell(params, door->x, door->y);
+    interlace_invalidate(params); // A sliding door must not tear
+    if (was_open != (door->open >= 1.0)) // Light passes fully open doors
+      lighting_relight_cell(params, door->x, door->y);
+  }
+}
+
+/**
+ * Tests a ray crossing the recessed slab of the door in cell (x, y), which
+ * lies on the cell's middle line. mid is where the ray crosses that line.
+ * The open part of the door has slid into the neighbouring wall.
+ */
+bool door_blocks_ray(t_params *params, int x, int y, bool vertical,
+                     t_fpoint mid) {
+  t_door *door = door_at(params, x, y);
+  double along, origin;
+
+  if (!door || door->vertical != vertical)
+    return false;
+  if ((int)(mid.x / TILE_SIZE) != x || (int)(mid.y / TILE_SIZE) != y)
+    return false;
+  along = vertical ? mid.y : mid.x;
+  origin = (vertical ? y : x) * TILE_SIZE;
+  return along - origin >= door->open * TILE_SIZE;
+}
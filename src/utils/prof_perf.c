@@ -0,0 +1,166 @@
+#include "../../include/cub3d.h"
+
+#ifdef PROFILE
+
+// --- Hardware Counters for the Profiler ---
+//
+// prof_perf_init picks the event set once, on the main thread: the
+// hardware group if the kernel opens it, the software one otherwise (VMs
+// without a virtual PMU refuse every hardware event). Every thread then
+// opens its own group of that set on its first read and counts only
+// itself, in user space, so no perf_event_paranoid change is needed. The
+// descriptors are closed with the process.
+
+typedef struct s_perf_event {
+  unsigned int type;
+  unsigned long long config;
+  const char *name;
+} t_perf_event;
+
+static const t_perf_event *g_perf_set;
+static int g_perf_count;
+static bool g_perf_hw_set;
+static __thread int g_perf_fd = -1;
+static __thread bool g_perf_tried;
+
+# ifdef __linux__
+
+#  include <errno.h>
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+static const t_perf_event g_perf_hw[PERF_MAX_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache-misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch-misses"},
+};
+
+static const t_perf_event g_perf_sw[PERF_MAX_EVENTS] = {
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, "task-clock-ns"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, "page-faults"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context-switches"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS, "cpu-migrations"},
+};
+
+static int open_event(const t_perf_event *event, int group) {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event->type;
+  attr.config = event->config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// Opens set as one group counting the calling thread; the leader's fd.
+// Members are read through the leader, their fds only keep them open.
+static int open_group(const t_perf_event *set) {
+  int fds[PERF_MAX_EVENTS], i, saved;
+
+  for (i = 0; i < PERF_MAX_EVENTS; i++) {
+    fds[i] = open_event(&set[i], (i == 0) ? -1 : fds[0]);
+    if (fds[i] < 0) {
+      saved = errno;
+      while (i-- > 0)
+        close(fds[i]);
+      errno = saved;
+      return -1;
+    }
+  }
+  return fds[0];
+}
+
+/**
+ * Enables the counters for every thread that profiles from now on.
+ *
+ * @return 0 with hardware or software events, -1 after printing why
+ *         there are none; the profiler then keeps to timing
+ */
+int prof_perf_init(void) {
+  int hw_errno;
+
+  g_perf_fd = open_group(g_perf_hw);
+  if (g_perf_fd >= 0) {
+    g_perf_set = g_perf_hw;
+    g_perf_hw_set = true;
+  } else {
+    hw_errno = errno;
+    g_perf_fd = open_group(g_perf_sw);
+    if (g_perf_fd < 0) {
+      fprintf(stderr, "perf: counters unavailable (%s), timing only\n",
+              strerror(errno));
+      return -1;
+    }
+    fprintf(stderr,
+            "perf: hardware counters unavailable (%s), using software "
+            "events\n",
+            strerror(hw_errno));
+    g_perf_set = g_perf_sw;
+  }
+  g_perf_tried = true;
+  __atomic_store_n(&g_perf_count, PERF_MAX_EVENTS, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+ * Reads the calling thread's counters, opening them on first use.
+ *
+ * @return 0 on success, -1 if the counters are off or this thread has
+ *         none
+ */
+int prof_perf_read(t_perf_sample *sample) {
+  unsigned long long buf[3 + PERF_MAX_EVENTS];
+  int i;
+
+  if (__atomic_load_n(&g_perf_count, __ATOMIC_ACQUIRE) == 0)
+    return -1;
+  if (!g_perf_tried) {
+    g_perf_tried = true;
+    g_perf_fd = open_group(g_perf_set);
+  }
+  if (g_perf_fd < 0 || read(g_perf_fd, buf, sizeof(buf)) != sizeof(buf))
+    return -1;
+  sample->enabled = buf[1];
+  sample->running = buf[2];
+  for (i = 0; i < PERF_MAX_EVENTS; i++)
+    sample->value[i] = buf[3 + i];
+  return 0;
+}
+
+# else
+
+int prof_perf_init(void) {
+  fprintf(stderr, "perf: counters need Linux perf_event, timing only\n");
+  return -1;
+}
+
+int prof_perf_read(t_perf_sample *sample) {
+  (void)sample;
+  (void)g_perf_fd;
+  (void)g_perf_tried;
+  return -1;
+}
+
+# endif
+
+// Events per sample, 0 while the counters are off.
+int prof_perf_events(void) {
+  return __atomic_load_n(&g_perf_count, __ATOMIC_ACQUIRE);
+}
+
+const char *prof_perf_name(int event) {
+  return g_perf_set[event].name;
+}
+
+// Whether events 0 and 1 are cycles and instructions, so IPC makes sense.
+bool prof_perf_hardware(void) {
+  return prof_perf_events() > 0 && g_perf_hw_set;
+}
+
+#endif
@@ -0,0 +1,357 @@
+#include "../../include/cub3d.h"
+
+#ifdef PROFILE
+
+#include <signal.h>
+
+// --- Frame Profiler ---
+//
+// Each thread lazily claims one of PROF_MAX_THREADS rings on its first
+// sample and is the only writer of it. The report reads the rings without
+// synchronisation: at exit the render thread has been joined, and on a key
+// press the main thread holds frame_lock (render_pause), which the render
+// thread keeps for the whole of render_frame, where all its stages are
+// recorded.
+
+static t_prof_ring g_rings[PROF_MAX_THREADS];
+static const char *g_thread_names[PROF_MAX_THREADS];
+static int g_ring_count;
+static __thread int g_slot = -1;
+
+static t_trace g_trace;
+static volatile sig_atomic_t g_trace_signal;
+
+static const char *g_stage_names[PROF_STAGES] = {
+    "sim",  "clear",   "cast",    "walls", "sprites",
+    "post", "minimap", "present", "sleep"};
+
+// Returns this thread's ring slot, or -1 once every slot is taken.
+static int thread_slot(void) {
+  if (g_slot < 0) {
+    g_slot = __atomic_fetch_add(&g_ring_count, 1, __ATOMIC_RELAXED);
+    if (g_slot >= PROF_MAX_THREADS)
+      g_slot = PROF_MAX_THREADS;
+  }
+  return (g_slot < PROF_MAX_THREADS) ? g_slot : -1;
+}
+
+// Names the calling thread in the trace; unnamed threads show their slot.
+void prof_thread(const char *name) {
+  int slot = thread_slot();
+
+  if (slot >= 0)
+    g_thread_names[slot] = name;
+}
+
+static void trace_append(t_prof_stage stage, int slot, long start_ns,
+                         long ns) {
+  unsigned long i = __atomic_fetch_add(&g_trace.count, 1, __ATOMIC_RELAXED);
+  t_trace_event *e;
+
+  if (i >= TRACE_MAX_EVENTS)
+    return;
+  e = &g_trace.events[i];
+  e->start_ns = start_ns;
+  e->dur_ns = (unsigned int)ns;
+  e->frame = __atomic_load_n(&g_trace.frame, __ATOMIC_RELAXED);
+  e->stage = (unsigned char)stage;
+  e->tid = (unsigned char)slot;
+}
+
+void prof_record(t_prof_stage stage, long start_ns, long end_ns) {
+  long ns = (end_ns > start_ns) ? end_ns - start_ns : 0;
+  int slot = thread_slot();
+  t_prof_ring *ring;
+
+  if (slot < 0)
+    return;
+  ring = &g_rings[slot];
+  ring->samples[stage][ring->count[stage] % PROF_RING_SIZE] = (unsigned int)ns;
+  ring->count[stage]++;
+  if (__atomic_load_n(&g_trace.state, __ATOMIC_ACQUIRE) == TRACE_ACTIVE)
+    trace_append(stage, slot, start_ns, ns);
+}
+
+/**
+ * Marks the start of a stage. The counters are read before the clock,
+ * and after it in prof_end, so their syscalls stay out of the timing.
+ */
+t_prof_mark prof_begin(void) {
+  t_prof_mark mark;
+
+  mark.perf_ok = (prof_perf_read(&mark.perf) == 0);
+  mark.ns = get_time_ns();
+  return mark;
+}
+
+// Adds the counter deltas of a stage, unless the group was multiplexed
+// off the PMU for part of it and the deltas are short.
+static void add_perf(t_prof_stage stage, const t_perf_sample *from) {
+  t_perf_sample to;
+  int slot, i;
+
+  if (prof_perf_read(&to) != 0 ||
+      to.running - from->running != to.enabled - from->enabled)
+    return;
+  slot = thread_slot();
+  if (slot < 0)
+    return;
+  for (i = 0; i < PERF_MAX_EVENTS; i++)
+    g_rings[slot].perf[stage][i] += to.value[i] - from->value[i];
+  g_rings[slot].perf_count[stage]++;
+}
+
+void prof_end(t_prof_stage stage, const t_prof_mark *mark) {
+  long end_ns = get_time_ns();
+
+  if (mark->perf_ok)
+    add_perf(stage, &mark->perf);
+  prof_record(stage, mark->ns, end_ns);
+}
+
+static int compare_samples(const void *a, const void *b) {
+  unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+
+  return (x > y) - (x < y);
+}
+
+// Copies the live samples of stage from every ring into out.
+static int gather(t_prof_stage stage, unsigned int *out) {
+  int rings = (g_ring_count < PROF_MAX_THREADS) ? g_ring_count
+                                                : PROF_MAX_THREADS;
+  unsigned long n;
+  int r, total = 0;
+
+  for (r = 0; r < rings; r++) {
+    n = g_rings[r].count[stage];
+    n = (n < PROF_RING_SIZE) ? n : PROF_RING_SIZE;
+    memcpy(out + total, g_rings[r].samples[stage], n * sizeof(*out));
+    total += (int)n;
+  }
+  return total;
+}
+
+const char *prof_stage_name(t_prof_stage stage) {
+  return g_stage_names[stage];
+}
+
+/**
+ * Summarises the last PROF_RING_SIZE samples per thread of stage. Not
+ * reentrant: call from one thread at a time, under the same conditions
+ * as prof_report.
+ *
+ * @return the number of samples, 0 if the stage never ran
+ */
+int prof_stage_stats(t_prof_stage stage, t_prof_stats *stats) {
+  static unsigned int sorted[PROF_MAX_THREADS * PROF_RING_SIZE];
+  double sum = 0.0;
+  int n = gather(stage, sorted), i;
+
+  ft_memset(stats, 0, sizeof(*stats));
+  if (n == 0)
+    return 0;
+  qsort(sorted, n, sizeof(*sorted), compare_samples);
+  for (i = 0; i < n; i++)
+    sum += sorted[i];
+  stats->samples = n;
+  stats->mean_us = sum / n / 1000.0;
+  stats->p50_us = sorted[n / 2] / 1000.0;
+  stats->p95_us = sorted[n * 95 / 100] / 1000.0;
+  stats->p99_us = sorted[n * 99 / 100] / 1000.0;
+  return n;
+}
+
+/**
+ * Averages the counter deltas of stage over every run of it since the
+ * last reset, one entry of mean per prof_perf_events().
+ *
+ * @return the number of runs counted, 0 without counters
+ */
+int prof_stage_perf(t_prof_stage stage, double *mean) {
+  unsigned long long sum[PERF_MAX_EVENTS] = {0};
+  unsigned long n = 0;
+  int r, i;
+
+  for (r = 0; r < g_ring_count && r < PROF_MAX_THREADS; r++) {
+    n += g_rings[r].perf_count[stage];
+    for (i = 0; i < PERF_MAX_EVENTS; i++)
+      sum[i] += g_rings[r].perf[stage][i];
+  }
+  for (i = 0; n > 0 && i < PERF_MAX_EVENTS; i++)
+    mean[i] = (double)sum[i] / n;
+  return (int)n;
+}
+
+// Drops every sample so far, e.g. after warm-up. Same rules as the report.
+void prof_reset(void) {
+  int r;
+
+  for (r = 0; r < PROF_MAX_THREADS; r++) {
+    ft_memset(g_rings[r].count, 0, sizeof(g_rings[r].count));
+    ft_memset(g_rings[r].perf, 0, sizeof(g_rings[r].perf));
+    ft_memset(g_rings[r].perf_count, 0, sizeof(g_rings[r].perf_count));
+  }
+}
+
+// Mean counter deltas per stage run, with IPC for the hardware events.
+static void report_perf(FILE *out) {
+  double mean[PERF_MAX_EVENTS];
+  int s, i, n = prof_perf_events(), runs;
+
+  if (n == 0)
+    return;
+  fprintf(out, "perf:    %-7s %9s", "stage", "runs");
+  for (i = 0; i < n; i++)
+    fprintf(out, " %16s", prof_perf_name(i));
+  fprintf(out, prof_perf_hardware() ? " %6s\n" : "\n", "IPC");
+  for (s = 0; s < PROF_STAGES; s++) {
+    runs = prof_stage_perf(s, mean);
+    if (runs == 0)
+      continue;
+    fprintf(out, "  %-14s %9d", g_stage_names[s], runs);
+    for (i = 0; i < n; i++)
+      fprintf(out, " %16.0f", mean[i]);
+    if (prof_perf_hardware())
+      fprintf(out, " %6.2f", mean[0] > 0 ? mean[1] / mean[0] : 0.0);
+    fputc('\n', out);
+  }
+}
+
+// Prints count, mean and p50/p95/p99 of every stage that has samples,
+// then the counters if --perf opened any.
+void prof_report(FILE *out) {
+  t_prof_stats st;
+  int s;
+
+  fprintf(out, "profile: %-7s %9s %9s %9s %9s %9s (us)\n", "stage", "samples",
+          "mean", "p50", "p95", "p99");
+  for (s = 0; s < PROF_STAGES; s++)
+    if (prof_stage_stats(s, &st) > 0)
+      fprintf(out, "  %-14s %9d %9.1f %9.1f %9.1f %9.1f\n", g_stage_names[s],
+              st.samples, st.mean_us, st.p50_us, st.p95_us, st.p99_us);
+  report_perf(out);
+}
+
+// --- Trace Export ---
+//
+// The window state only moves forward on the thread that renders, in
+// prof_frame, and back to idle on the main thread once the file is
+// written. Threads append to the shared buffer with one atomic add while
+// a window is active and skip it with a single load otherwise.
+
+static void on_trace_signal(int sig) {
+  (void)sig;
+  g_trace_signal = 1;
+}
+
+/**
+ * Preallocates the event buffer and installs the SIGUSR1 trigger, which
+ * traces the next TRACE_DEFAULT_FRAMES frames. With first >= 0, frames
+ * [first, first + count) are traced as well.
+ *
+ * @param path Output file, TRACE_DEFAULT_PATH if NULL
+ * @return 0 on success, -1 if the buffer cannot be allocated
+ */
+int prof_trace_init(const char *path, int first, int count) {
+  struct sigaction sa;
+
+  g_trace.events = malloc(sizeof(*g_trace.events) * TRACE_MAX_EVENTS);
+  if (!g_trace.events)
+    return -1;
+  g_trace.path = path ? path : TRACE_DEFAULT_PATH;
+  if (first >= 0) {
+    g_trace.first = (unsigned int)first;
+    g_trace.last = g_trace.first +
+                   (unsigned int)(count > 0 ? count : TRACE_DEFAULT_FRAMES);
+    g_trace.state = TRACE_ARMED;
+  }
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_trace_signal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &sa, NULL);
+  return 0;
+}
+
+// Starts a frame: opens or closes the trace window. Call on the thread
+// that renders, before the frame's first stage.
+void prof_frame(void) {
+  unsigned int frame =
+      __atomic_fetch_add(&g_trace.frame, 1, __ATOMIC_RELAXED) + 1;
+  int state = __atomic_load_n(&g_trace.state, __ATOMIC_ACQUIRE);
+  int next = state;
+
+  if (state == TRACE_IDLE && g_trace_signal && g_trace.events) {
+    g_trace_signal = 0;
+    g_trace.first = frame;
+    g_trace.last = frame + TRACE_DEFAULT_FRAMES;
+    next = TRACE_ARMED;
+  }
+  if (next == TRACE_ARMED && frame >= g_trace.first) {
+    g_trace.count = 0;
+    next = TRACE_ACTIVE;
+  } else if (next == TRACE_ACTIVE && frame >= g_trace.last)
+    next = TRACE_DONE;
+  if (next != state)
+    __atomic_store_n(&g_trace.state, next, __ATOMIC_RELEASE);
+}
+
+static void trace_write(FILE *out, unsigned long n) {
+  long base = LONG_MAX;
+  unsigned long i;
+  int t;
+
+  for (i = 0; i < n; i++)
+    base = (g_trace.events[i].start_ns < base) ? g_trace.events[i].start_ns
+                                                : base;
+  fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+               "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+               "\"args\":{\"name\":\"cub3D\"}}");
+  for (t = 0; t < g_ring_count && t < PROF_MAX_THREADS; t++)
+    fprintf(out,
+            ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s\"}}",
+            t, g_thread_names[t] ? g_thread_names[t] : "worker");
+  for (i = 0; i < n; i++)
+    fprintf(out,
+            ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,"
+            "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+            g_stage_names[g_trace.events[i].stage], g_trace.events[i].tid,
+            (g_trace.events[i].start_ns - base) / 1000.0,
+            g_trace.events[i].dur_ns / 1000.0, g_trace.events[i].frame);
+  fprintf(out, "\n]}\n");
+}
+
+/**
+ * Writes the trace file once its window has closed and rearms the signal.
+ * Call from the main thread. With force, an unfinished window is written
+ * too and the buffer freed; only do that once the render thread is gone.
+ */
+void prof_trace_flush(bool force) {
+  int state = __atomic_load_n(&g_trace.state, __ATOMIC_ACQUIRE);
+  unsigned long n = g_trace.count;
+  FILE *out;
+
+  if (!g_trace.events)
+    return;
+  if (state == TRACE_DONE || (force && state == TRACE_ACTIVE)) {
+    n = (n < TRACE_MAX_EVENTS) ? n : TRACE_MAX_EVENTS;
+    out = fopen(g_trace.path, "w");
+    if (!out)
+      perror(g_trace.path);
+    else {
+      trace_write(out, n);
+      fclose(out);
+      fprintf(stderr, "trace: frames %u-%u, %lu events to %s (%lu dropped)\n",
+              g_trace.first, g_trace.last - 1, n, g_trace.path,
+              g_trace.count - n);
+    }
+    __atomic_store_n(&g_trace.state, TRACE_IDLE, __ATOMIC_RELEASE);
+  }
+  if (force) {
+    free(g_trace.events);
+    g_trace.events = NULL;
+  }
+}
+
+#endif
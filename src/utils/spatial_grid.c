@@ -0,0 +1,268 @@
+#include "../../include/spatial_grid.h"
+#include <math.h>
+#include <stdlib.h>
+
+// --- Spatial Grid ---
+
+#define GRID_NONE -1
+
+int grid_init(t_spatial_grid *grid, int cols, int rows, double cell_size) {
+  int i;
+
+  grid->cols = cols;
+  grid->rows = rows;
+  grid->cell_size = cell_size;
+  grid->entries = NULL;
+  grid->capacity = 0;
+  grid->count = 0;
+  grid->heads = malloc((size_t)cols * rows * sizeof(int));
+  if (!grid->heads)
+    return -1;
+  for (i = 0; i < cols * rows; i++)
+    grid->heads[i] = GRID_NONE;
+  return 0;
+}
+
+void grid_free(t_spatial_grid *grid) {
+  free(grid->heads);
+  free(grid->entries);
+  grid->heads = NULL;
+  grid->entries = NULL;
+  grid->capacity = 0;
+  grid->count = 0;
+}
+
+// Cell of a world position; positions off the map land in the border cells.
+static int cell_of(t_spatial_grid *grid, double x, double y) {
+  int cx = (int)floor(x / grid->cell_size);
+  int cy = (int)floor(y / grid->cell_size);
+
+  cx = (cx < 0) ? 0 : (cx >= grid->cols ? grid->cols - 1 : cx);
+  cy = (cy < 0) ? 0 : (cy >= grid->rows ? grid->rows - 1 : cy);
+  return cy * grid->cols + cx;
+}
+
+static void link_entry(t_spatial_grid *grid, int id, int cell) {
+  t_grid_entry *e = &grid->entries[id];
+
+  e->cell = cell;
+  e->prev = GRID_NONE;
+  e->next = grid->heads[cell];
+  if (e->next != GRID_NONE)
+    grid->entries[e->next].prev = id;
+  grid->heads[cell] = id;
+}
+
+static void unlink_entry(t_spatial_grid *grid, int id) {
+  t_grid_entry *e = &grid->entries[id];
+
+  if (e->prev != GRID_NONE)
+    grid->entries[e->prev].next = e->next;
+  else
+    grid->heads[e->cell] = e->next;
+  if (e->next != GRID_NONE)
+    grid->entries[e->next].prev = e->prev;
+  e->cell = GRID_NONE;
+}
+
+static int reserve(t_spatial_grid *grid, int id) {
+  t_grid_entry *entries;
+  int capacity = grid->capacity ? grid->capacity : 64;
+  int i;
+
+  while (capacity <= id)
+    capacity *= 2;
+  entries = realloc(grid->entries, capacity * sizeof(*entries));
+  if (!entries)
+    return -1;
+  for (i = grid->capacity; i < capacity; i++)
+    entries[i].cell = GRID_NONE;
+  grid->entries = entries;
+  grid->capacity = capacity;
+  return 0;
+}
+
+bool grid_contains(t_spatial_grid *grid, int id) {
+  return id >= 0 && id < grid->capacity &&
+         grid->entries[id].cell != GRID_NONE;
+}
+
+/**
+ * Adds entity id at (x, y), or moves it there if already present.
+ *
+ * @return 0 on success, -1 on allocation failure
+ */
+int grid_insert(t_spatial_grid *grid, int id, double x, double y) {
+  if (id < 0 || (id >= grid->capacity && reserve(grid, id) != 0))
+    return -1;
+  if (grid->entries[id].cell != GRID_NONE) {
+    grid_move(grid, id, x, y);
+    return 0;
+  }
+  grid->entries[id].x = x;
+  grid->entries[id].y = y;
+  link_entry(grid, id, cell_of(grid, x, y));
+  grid->count++;
+  return 0;
+}
+
+/**
+ * Updates the position of a present entity. Relinks only when it crossed
+ * into another cell.
+ */
+void grid_move(t_spatial_grid *grid, int id, double x, double y) {
+  t_grid_entry *e;
+  int cell;
+
+  if (!grid_contains(grid, id))
+    return;
+  e = &grid->entries[id];
+  e->x = x;
+  e->y = y;
+  cell = cell_of(grid, x, y);
+  if (cell == e->cell)
+    return;
+  unlink_entry(grid, id);
+  link_entry(grid, id, cell);
+}
+
+void grid_remove(t_spatial_grid *grid, int id) {
+  if (!grid_contains(grid, id))
+    return;
+  unlink_entry(grid, id);
+  grid->count--;
+}
+
+typedef struct s_cell_range {
+  int x0;
+  int y0;
+  int x1; // Inclusive
+  int y1; // Inclusive
+} t_cell_range;
+
+static bool clip_range(t_spatial_grid *grid, t_cell_range *r, double min_x,
+                       double min_y, double max_x, double max_y) {
+  r->x0 = (int)floor(min_x / grid->cell_size);
+  r->y0 = (int)floor(min_y / grid->cell_size);
+  r->x1 = (int)floor(max_x / grid->cell_size);
+  r->y1 = (int)floor(max_y / grid->cell_size);
+  r->x0 = (r->x0 < 0) ? 0 : r->x0;
+  r->y0 = (r->y0 < 0) ? 0 : r->y0;
+  r->x1 = (r->x1 >= grid->cols) ? grid->cols - 1 : r->x1;
+  r->y1 = (r->y1 >= grid->rows) ? grid->rows - 1 : r->y1;
+  return r->x0 <= r->x1 && r->y0 <= r->y1;
+}
+
+/**
+ * Collects the ids of entities within radius of (x, y).
+ *
+ * @return the number of matches; only the first max_out are stored
+ */
+int grid_query_radius(t_spatial_grid *grid, double x, double y, double radius,
+                      int *out, int max_out) {
+  t_cell_range r;
+  t_grid_entry *e;
+  double dx, dy;
+  int cx, cy, id, found = 0;
+
+  if (!clip_range(grid, &r, x - radius, y - radius, x + radius, y + radius))
+    return 0;
+  for (cy = r.y0; cy <= r.y1; cy++) {
+    for (cx = r.x0; cx <= r.x1; cx++) {
+      for (id = grid->heads[cy * grid->cols + cx]; id != GRID_NONE;
+           id = e->next) {
+        e = &grid->entries[id];
+        dx = e->x - x;
+        dy = e->y - y;
+        if (dx * dx + dy * dy > radius * radius)
+          continue;
+        if (found < max_out)
+          out[found] = id;
+        found++;
+      }
+    }
+  }
+  return found;
+}
+
+typedef struct s_cone {
+  double fx, fy; // Forward axis
+  double lx, ly; // Inward normal of the left edge
+  double rx, ry; // Inward normal of the right edge
+} t_cone;
+
+static bool in_cone(const t_grid_frustum *f, const t_cone *c, double x,
+                    double y, double margin) {
+  double vx = x - f->x, vy = y - f->y;
+  double forward = vx * c->fx + vy * c->fy;
+
+  return forward >= -margin && forward <= f->far + margin &&
+         vx * c->lx + vy * c->ly >= -margin &&
+         vx * c->rx + vy * c->ry >= -margin;
+}
+
+static void cone_bounds(const t_grid_frustum *f, double *min, double *max) {
+  double reach = f->far / cos(f->half_fov);
+  double px[3], py[3];
+  int i;
+
+  px[0] = f->x;
+  py[0] = f->y;
+  px[1] = f->x + cos(f->dir - f->half_fov) * reach;
+  py[1] = f->y + sin(f->dir - f->half_fov) * reach;
+  px[2] = f->x + cos(f->dir + f->half_fov) * reach;
+  py[2] = f->y + sin(f->dir + f->half_fov) * reach;
+  min[0] = max[0] = px[0];
+  min[1] = max[1] = py[0];
+  for (i = 1; i < 3; i++) {
+    min[0] = fmin(min[0], px[i]);
+    max[0] = fmax(max[0], px[i]);
+    min[1] = fmin(min[1], py[i]);
+    max[1] = fmax(max[1], py[i]);
+  }
+}
+
+/**
+ * Collects the ids of entities inside the view cone. Cells are rejected
+ * as a whole before their buckets are walked.
+ *
+ * @return the number of matches; only the first max_out are stored
+ */
+int grid_query_frustum(t_spatial_grid *grid, const t_grid_frustum *f, int *out,
+                       int max_out) {
+  double cell_margin = f->margin + grid->cell_size * M_SQRT1_2;
+  double min[2], max[2];
+  t_cell_range r;
+  t_grid_entry *e;
+  t_cone c;
+  int cx, cy, id, found = 0;
+
+  c.fx = cos(f->dir);
+  c.fy = sin(f->dir);
+  c.lx = -sin(f->dir - f->half_fov);
+  c.ly = cos(f->dir - f->half_fov);
+  c.rx = sin(f->dir + f->half_fov);
+  c.ry = -cos(f->dir + f->half_fov);
+  cone_bounds(f, min, max);
+  if (!clip_range(grid, &r, min[0] - f->margin, min[1] - f->margin,
+                  max[0] + f->margin, max[1] + f->margin))
+    return 0;
+  for (cy = r.y0; cy <= r.y1; cy++) {
+    for (cx = r.x0; cx <= r.x1; cx++) {
+      id = grid->heads[cy * grid->cols + cx];
+      if (id == GRID_NONE || !in_cone(f, &c, (cx + 0.5) * grid->cell_size,
+                                      (cy + 0.5) * grid->cell_size,
+                                      cell_margin))
+        continue;
+      for (; id != GRID_NONE; id = e->next) {
+        e = &grid->entries[id];
+        if (!in_cone(f, &c, e->x, e->y, f->margin))
+          continue;
+        if (found < max_out)
+          out[found] = id;
+        found++;
+      }
+    }
+  }
+  return found;
+}
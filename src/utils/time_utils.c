@@ -0,0 +1,19 @@
+#include "../../include/cub3d.h"
+#include <time.h>
+
+// All clocks are CLOCK_MONOTONIC: frame timing and the simulation must not
+// jump when the wall clock is adjusted.
+
+long get_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000000L + ts.tv_nsec);
+}
+
+long get_time_ms(void) {
+  return (get_time_ns() / 1000000L);
+}
+
+long get_time_us(void) {
+  return (get_time_ns() / 1000L);
+}
@@ -0,0 +1,377 @@
+#include "../include/cub3d.h"
+#include <sys/stat.h>
+
+// --- Golden-Image and Performance Regression Tests ---
+//
+// Renders canned maps and camera poses headlessly and compares each frame,
+// box-filtered down by GOLDEN_SCALE, with its golden in tests/goldens: it
+// passes when at most GOLDEN_MAX_BAD pixels differ by more than
+// GOLDEN_TOLERANCE in some channel. A failing case leaves the frame and a
+// diff image (red: over tolerance, grey: amplified difference) in
+// tests/out. The render time of each case, the fastest of PERF_RUNS
+// medians after a warm-up, is also checked against tests/perf_baseline.txt;
+// PERF_THRESHOLD sets the allowed slowdown in percent and 0 skips the
+// check. Timings only compare on one machine, so the baseline is not
+// versioned: --baseline writes it from the current timings, and without
+// one the check is skipped. --update also accepts the current frames as
+// the new goldens.
+
+#define GOLDEN_DIR "tests/goldens"
+#define OUT_DIR "tests/out"
+#define BASELINE_PATH "tests/perf_baseline.txt"
+#define GOLDEN_SCALE 8
+#define GOLDEN_W (WINDOW_WIDTH / GOLDEN_SCALE)
+#define GOLDEN_H (WINDOW_HEIGHT / GOLDEN_SCALE)
+#define GOLDEN_TOLERANCE 8
+#define GOLDEN_MAX_BAD 16
+#define PERF_WARMUP 5
+#define PERF_RUNS 5
+#define PERF_FRAMES 15
+#define PERF_DEFAULT_THRESHOLD 25.0
+#define PILLARS_SIZE 48
+#define MAX_CASES 16
+
+typedef struct s_case {
+  const char *name;
+  const char *const *layout;
+  int rows;
+  double x; // Tiles, or < 0 to keep the start pose
+  double y;
+  double direction;
+  void (*setup)(t_params *params);
+} t_case;
+
+typedef struct s_baseline {
+  char names[MAX_CASES][64];
+  double ms[MAX_CASES];
+  int count;
+} t_baseline;
+
+static const char *const g_demo[] = {
+    "1111111111111111111111111", "1000200001000002000000101",
+    "1011D10111011001011101101", "1001002000010001000100001",
+    "1011011111D110W0011101001", "1002000010000000000200001",
+    "1001000010000111111000101", "1010001010000000001000101",
+    "1111111111111111111111111"};
+
+static const char *const g_closet[] = {"11111", "10001", "10E01", "10001",
+                                       "11111"};
+
+static char g_pillar_rows[PILLARS_SIZE][PILLARS_SIZE + 1];
+static const char *g_pillars[PILLARS_SIZE];
+
+// The benchmark map: a pillar every 4 cells and a lamp every 6.
+static void make_pillars(void) {
+  int x, y;
+  bool border;
+
+  for (y = 0; y < PILLARS_SIZE; y++) {
+    for (x = 0; x < PILLARS_SIZE; x++) {
+      border = x == 0 || y == 0 || x == PILLARS_SIZE - 1 ||
+               y == PILLARS_SIZE - 1;
+      g_pillar_rows[y][x] = (border || (x % 4 == 0 && y % 4 == 0)) ? WALL
+                            : (x % 6 == 3 && y % 6 == 3)          ? SPRITE
+                                                                   : EMPTY;
+    }
+    g_pillar_rows[y][PILLARS_SIZE] = '\0';
+    g_pillars[y] = g_pillar_rows[y];
+  }
+  g_pillar_rows[PILLARS_SIZE / 2 - 2][PILLARS_SIZE / 2 - 2] = PLAYER_EAST;
+}
+
+static void setup_indexed(t_params *params) {
+  params->indexed.enabled = true;
+}
+
+static void setup_565(t_params *params) {
+  params->textures_565 = true;
+}
+
+static void setup_plain(t_params *params) {
+  params->sky_enabled = false;
+  params->lighting.enabled = false;
+  params->post.flags = 0;
+}
+
+static int ppm_write(const char *path, const unsigned char *rgb, int w,
+                     int h) {
+  FILE *f = fopen(path, "wb");
+  int ok;
+
+  if (!f)
+    return -1;
+  fprintf(f, "P6\n%d %d\n255\n", w, h);
+  ok = fwrite(rgb, 3, (size_t)w * h, f) == (size_t)w * h;
+  return (fclose(f) == 0 && ok) ? 0 : -1;
+}
+
+static int ppm_read(const char *path, unsigned char *rgb, int w, int h) {
+  FILE *f = fopen(path, "rb");
+  int fw, fh, max, ok;
+
+  if (!f)
+    return -1;
+  ok = fscanf(f, "P6 %d %d %d", &fw, &fh, &max) == 3 && fw == w &&
+       fh == h && max == 255 && fgetc(f) != EOF &&
+       fread(rgb, 3, (size_t)w * h, f) == (size_t)w * h;
+  fclose(f);
+  return ok ? 0 : -1;
+}
+
+static void frame_rgb(const t_img *img, unsigned char *rgb) {
+  const unsigned int *row;
+  int x, y;
+
+  for (y = 0; y < img->height; y++) {
+    row = (const unsigned int *)(img->addr + y * img->line_length);
+    for (x = 0; x < img->width; x++, rgb += 3) {
+      rgb[0] = row[x] >> 16;
+      rgb[1] = row[x] >> 8;
+      rgb[2] = row[x];
+    }
+  }
+}
+
+static void downscale(const unsigned char *full, unsigned char *small) {
+  int x, y, c, dx, dy, sum;
+
+  for (y = 0; y < GOLDEN_H; y++)
+    for (x = 0; x < GOLDEN_W; x++)
+      for (c = 0; c < 3; c++) {
+        sum = 0;
+        for (dy = 0; dy < GOLDEN_SCALE; dy++)
+          for (dx = 0; dx < GOLDEN_SCALE; dx++)
+            sum += full[((y * GOLDEN_SCALE + dy) * WINDOW_WIDTH +
+                         x * GOLDEN_SCALE + dx) * 3 + c];
+        small[(y * GOLDEN_W + x) * 3 + c] =
+            (sum + GOLDEN_SCALE * GOLDEN_SCALE / 2) /
+            (GOLDEN_SCALE * GOLDEN_SCALE);
+      }
+}
+
+/**
+ * Compares two downscaled frames and fills diff with the diff image.
+ *
+ * @return the number of pixels over GOLDEN_TOLERANCE
+ */
+static int compare(const unsigned char *a, const unsigned char *b,
+                   unsigned char *diff, int *max_diff) {
+  int i, c, d, worst, bad = 0;
+
+  *max_diff = 0;
+  for (i = 0; i < GOLDEN_W * GOLDEN_H; i++) {
+    worst = 0;
+    for (c = 0; c < 3; c++) {
+      d = abs(a[i * 3 + c] - b[i * 3 + c]);
+      worst = (d > worst) ? d : worst;
+    }
+    *max_diff = (worst > *max_diff) ? worst : *max_diff;
+    bad += worst > GOLDEN_TOLERANCE;
+    d = (worst > GOLDEN_TOLERANCE) ? 0 : worst * 255 / GOLDEN_TOLERANCE;
+    diff[i * 3] = (worst > GOLDEN_TOLERANCE) ? 255 : d;
+    diff[i * 3 + 1] = d;
+    diff[i * 3 + 2] = d;
+  }
+  return bad;
+}
+
+static int compare_ns(const void *a, const void *b) {
+  long x = *(const long *)a, y = *(const long *)b;
+
+  return (x > y) - (x < y);
+}
+
+// Median time of PERF_FRAMES frames of the scene, in milliseconds.
+static double median_frame(t_params *params, t_ray_hit *ray_hits) {
+  long ns[PERF_FRAMES], t0;
+  int i;
+
+  for (i = 0; i < PERF_FRAMES; i++) {
+    t0 = get_time_ns();
+    render_frame(params, ray_hits);
+    ns[i] = get_time_ns() - t0;
+  }
+  qsort(ns, PERF_FRAMES, sizeof(*ns), compare_ns);
+  return ns[PERF_FRAMES / 2] / 1e6;
+}
+
+// Fastest of PERF_RUNS medians after PERF_WARMUP frames: a run slowed down
+// by the rest of the machine does not count against the scene.
+static double time_frames(t_params *params, t_ray_hit *ray_hits) {
+  double best = 1e30, ms;
+  int i;
+
+  for (i = 0; i < PERF_WARMUP; i++)
+    render_frame(params, ray_hits);
+  for (i = 0; i < PERF_RUNS; i++) {
+    ms = median_frame(params, ray_hits);
+    best = (ms < best) ? ms : best;
+  }
+  return best;
+}
+
+static int load_case(t_params *params, const t_case *c) {
+  ft_memset(params, 0, sizeof(*params));
+  if (world_load(params, c->layout, c->rows) != 0)
+    return -1;
+  if (c->x >= 0.0) {
+    params->player.x = c->x * TILE_SIZE;
+    params->player.y = c->y * TILE_SIZE;
+    params->player.direction = c->direction;
+  }
+  if (c->setup)
+    c->setup(params);
+  params->window_img.width = WINDOW_WIDTH;
+  params->window_img.height = WINDOW_HEIGHT;
+  params->window_img.bpp = 4;
+  params->window_img.bits_per_pixel = 32;
+  params->window_img.line_length = WINDOW_WIDTH * 4;
+  params->window_img.addr = aligned_alloc(64, (size_t)WINDOW_WIDTH * 4 *
+                                                  WINDOW_HEIGHT);
+  return params->window_img.addr ? 0 : -1;
+}
+
+static double baseline_ms(const t_baseline *b, const char *name) {
+  int i;
+
+  for (i = 0; i < b->count; i++)
+    if (strcmp(b->names[i], name) == 0)
+      return b->ms[i];
+  return -1.0;
+}
+
+static void baseline_read(t_baseline *b) {
+  FILE *f = fopen(BASELINE_PATH, "r");
+  char line[128];
+
+  b->count = 0;
+  if (!f)
+    return;
+  while (b->count < MAX_CASES && fgets(line, sizeof(line), f))
+    if (line[0] != '#' && sscanf(line, "%63s %lf", b->names[b->count],
+                                 &b->ms[b->count]) == 2)
+      b->count++;
+  fclose(f);
+}
+
+static int baseline_write(const t_case *cases, const double *ms, int count) {
+  FILE *f = fopen(BASELINE_PATH, "w");
+  int i;
+
+  if (!f)
+    return -1;
+  fprintf(f, "# case ms: best of %d medians of %d frames at %dx%d\n",
+          PERF_RUNS, PERF_FRAMES, WINDOW_WIDTH, WINDOW_HEIGHT);
+  for (i = 0; i < count; i++)
+    fprintf(f, "%s %.3f\n", cases[i].name, ms[i]);
+  return fclose(f);
+}
+
+/**
+ * Checks the golden of one scene, or replaces it with update.
+ *
+ * @return true if the frame matches
+ */
+static bool check_golden(const t_case *c, const unsigned char *full,
+                         bool update) {
+  static unsigned char small[GOLDEN_W * GOLDEN_H * 3];
+  static unsigned char golden[GOLDEN_W * GOLDEN_H * 3];
+  static unsigned char diff[GOLDEN_W * GOLDEN_H * 3];
+  char path[256];
+  int bad, max_diff;
+
+  downscale(full, small);
+  snprintf(path, sizeof(path), GOLDEN_DIR "/%s.ppm", c->name);
+  if (update) {
+    printf("  %-14s golden updated", c->name);
+    return ppm_write(path, small, GOLDEN_W, GOLDEN_H) == 0;
+  }
+  if (ppm_read(path, golden, GOLDEN_W, GOLDEN_H) != 0) {
+    printf("  %-14s FAIL: no golden %s", c->name, path);
+    return false;
+  }
+  bad = compare(small, golden, diff, &max_diff);
+  printf("  %-14s %-4s %4d px over, max diff %3d", c->name,
+         (bad > GOLDEN_MAX_BAD) ? "FAIL" : "ok", bad, max_diff);
+  if (bad <= GOLDEN_MAX_BAD)
+    return true;
+  mkdir(OUT_DIR, 0755);
+  snprintf(path, sizeof(path), OUT_DIR "/%s_actual.ppm", c->name);
+  ppm_write(path, full, WINDOW_WIDTH, WINDOW_HEIGHT);
+  snprintf(path, sizeof(path), OUT_DIR "/%s_diff.ppm", c->name);
+  ppm_write(path, diff, GOLDEN_W, GOLDEN_H);
+  return false;
+}
+
+// Checks the time of one scene; always passes without a baseline.
+static bool check_time(const t_case *c, double ms, const t_baseline *b,
+                       double threshold) {
+  double base = baseline_ms(b, c->name);
+  double change = (base > 0.0) ? 100.0 * (ms - base) / base : 0.0;
+  bool slow = threshold > 0.0 && base > 0.0 && change > threshold;
+
+  if (base > 0.0)
+    printf(" | %7.3f ms (%+6.1f%%)%s\n", ms, change, slow ? " SLOW" : "");
+  else
+    printf(" | %7.3f ms\n", ms);
+  return !slow;
+}
+
+int main(int argc, char **argv) {
+  static t_params params;
+  static t_ray_hit ray_hits[NUM_RAYS];
+  static unsigned char full[WINDOW_WIDTH * WINDOW_HEIGHT * 3];
+  const t_case cases[] = {
+      {"demo_start", g_demo, 9, -1.0, 0.0, 0.0, NULL},
+      {"demo_door", g_demo, 9, 10.5, 5.5, 3.0 * M_PI / 2.0, NULL},
+      {"demo_sprites", g_demo, 9, 2.5, 1.5, 0.05, NULL},
+      {"demo_indexed", g_demo, 9, -1.0, 0.0, 0.0, setup_indexed},
+      {"demo_565", g_demo, 9, 6.5, 5.5, 0.4, setup_565},
+      {"demo_plain", g_demo, 9, 20.5, 5.5, 2.6, setup_plain},
+      {"closet", g_closet, 5, -1.0, 0.0, 0.0, NULL},
+      {"pillars", g_pillars, PILLARS_SIZE, -1.0, 0.0, 0.7, NULL},
+  };
+  const int count = sizeof(cases) / sizeof(cases[0]);
+  const char *env = getenv("PERF_THRESHOLD");
+  double threshold = (env && *env) ? atof(env) : PERF_DEFAULT_THRESHOLD;
+  bool update = argc > 1 && strcmp(argv[1], "--update") == 0;
+  bool write_baseline =
+      update || (argc > 1 && strcmp(argv[1], "--baseline") == 0);
+  double ms[MAX_CASES] = {0};
+  t_baseline baseline;
+  int i, failed = 0;
+  bool ok;
+
+  make_pillars();
+  baseline_read(&baseline);
+  if (write_baseline)
+    threshold = 0.0;
+  printf("render tests: %d scenes, tolerance %d per channel on %dx%d, "
+         "perf threshold %s%.0f%%\n",
+         count, GOLDEN_TOLERANCE, GOLDEN_W, GOLDEN_H,
+         threshold > 0.0 ? "+" : "off ", threshold);
+  if (!write_baseline && threshold > 0.0 && baseline.count == 0)
+    printf("  no %s on this machine, timings not checked "
+           "(make test-baseline writes one)\n",
+           BASELINE_PATH);
+  for (i = 0; i < count; i++) {
+    ok = load_case(&params, &cases[i]) == 0;
+    if (!ok)
+      printf("  %-14s FAIL: cannot set up the scene\n", cases[i].name);
+    else {
+      render_frame(&params, ray_hits);
+      frame_rgb(&params.window_img, full);
+      ok = check_golden(&cases[i], full, update);
+      ms[i] = time_frames(&params, ray_hits);
+      ok &= check_time(&cases[i], ms[i], &baseline, threshold);
+    }
+    failed += !ok;
+    free(params.window_img.addr);
+    world_free(&params);
+  }
+  if (write_baseline && baseline_write(cases, ms, count) != 0)
+    failed++;
+  printf("%s: %d of %d scenes failed\n", failed ? "FAILED" : "passed",
+         failed, count);
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}